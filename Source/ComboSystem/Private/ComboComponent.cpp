@@ -1,24 +1,216 @@
 #include "ComboComponent.h"	
 #include "Components/SkeletalMeshComponent.h"
+#include "Animation/AnimInstance.h"
+#include "ComboWorldSubsystem.h"
+#include "ComboMetrics.h"
+#include "ComboMoveSetLibrary.h"
+#include "ComboStaticMoveset.h"
+#include "ComboWindowNotifyState.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Net/UnrealNetwork.h"
+
+namespace
+{
+	// Load priority of a montage an attack is waiting for, above the prefetch of the montages that may follow it
+	constexpr TAsyncLoadPriority PendingAttackAnimationPriority = FStreamableManager::AsyncLoadHighPriority + 1;
+}
 
 UComboComponent::UComboComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
+	// Set this component to be initialized when the game starts.
+	// The component does not tick, its timers are updated together with every other combo component by the combo world subsystem.
+	PrimaryComponentTick.bCanEverTick = false;
+
+	// The server resolves the combos, clients predict their own and follow the server's state for everyone else
+	SetIsReplicatedByDefault(true);
+}
+
+void UComboComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
+	DOREPLIFETIME(UComboComponent, replicatedComboState);
 }
 
 
 void UComboComponent::OnAttackAnimationEnded(UAnimMontage *_montage, bool _wasInterrupted)
 {
+	// The delegate is bound on the whole anim instance, so it also fires for montages this component did not play
+	if (_montage != playingAttackAnimation)
+	{
+		return;
+	}
+
+	RecordComboEvent(EComboTraceEventType::MontageEnded, INDEX_NONE, 0, _wasInterrupted ? 1 : 0);
+
 #if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
 	// Debugging messages
-	if (GEngine)
+	if (GEngine && ComboMetrics::ShowDebugMessages())
 	{
 		GEngine->AddOnScreenDebugMessage(5, 1.5f, FColor::Red, TEXT("Attack animation ended"));
 	}
 #endif
+
+	// Attacks without combo windows end their chain when the combo reset deadline expires
+	if (attackUsesComboWindows == false)
+	{
+		return;
+	}
+
+	// A montage played again for the next attack of the chain blends its previous instance out, which is not the end of the chain
+	for (const TWeakObjectPtr<UAnimInstance>& animationTarget : animationTargets)
+	{
+		const UAnimInstance* animInstance = animationTarget.Get();
+		if (animInstance != nullptr && animInstance->Montage_IsPlaying(_montage))
+		{
+			return;
+		}
+	}
+
+	// Another montage cut the attack short, such as a hit reaction or a stun. The queued attack is dropped and the chain is broken.
+	if (_wasInterrupted)
+	{
+		queuedAttackNodeIndex = INDEX_NONE;
+		if (comboCursor.IsAtRoot() == false)
+		{
+			ResetComboSequence(false);
+		}
+		return;
+	}
+
+	// The montage had no cancel window, so the queued attack starts once it is over
+	if (queuedAttackNodeIndex != INDEX_NONE)
+	{
+		PerformQueuedAttack();
+		return;
+	}
+
+	// No input was taken in the attack's windows, so the chain is over
+	if (comboCursor.IsAtRoot() == false)
+	{
+		RecordComboEvent(EComboTraceEventType::ComboTimedOut, comboCursor.nodeIndex, GetComboDepth());
+		ResetComboSequence(false);
+	}
+}
+
+void UComboComponent::OpenComboWindow(EComboWindowType windowType, const UAnimSequenceBase* animation)
+{
+	// Windows of a montage that is still blending out, or that this component did not play, do not count
+	if (attackUsesComboWindows == false || animation != playingAttackAnimation)
+	{
+		return;
+	}
+
+	RecordComboEvent(EComboTraceEventType::ComboWindowOpened, comboCursor.nodeIndex, 0, static_cast<uint8>(windowType));
+
+	if (windowType == EComboWindowType::AcceptInput)
+	{
+		acceptInputWindowOpen = true;
+		return;
+	}
+
+	cancelWindowOpen = true;
+
+	// The attack can now be cut short by the input that was taken earlier
+	if (queuedAttackNodeIndex != INDEX_NONE)
+	{
+		PerformQueuedAttack();
+	}
+}
+
+void UComboComponent::CloseComboWindow(EComboWindowType windowType, const UAnimSequenceBase* animation)
+{
+	if (attackUsesComboWindows == false || animation != playingAttackAnimation)
+	{
+		return;
+	}
+
+	RecordComboEvent(EComboTraceEventType::ComboWindowClosed, comboCursor.nodeIndex, 0, static_cast<uint8>(windowType));
+
+	// The chain itself ends when the montage blends out, so that the rest of the attack still plays
+	if (windowType == EComboWindowType::AcceptInput)
+	{
+		acceptInputWindowOpen = false;
+	}
+	else
+	{
+		cancelWindowOpen = false;
+	}
+}
+
+void UComboComponent::ClearComboWindows()
+{
+	attackUsesComboWindows = false;
+	acceptInputWindowOpen = false;
+	cancelWindowOpen = false;
+	queuedAttackNodeIndex = INDEX_NONE;
+}
+
+void UComboComponent::OnAnimationTargetInitialized()
+{
+	animationTargetsDirty = true;
+}
+
+const TArray<TWeakObjectPtr<UAnimInstance>>& UComboComponent::GetAnimationTargets()
+{
+	AActor* owner = GetOwner();
+	const int32 ownerComponentCount = owner != nullptr ? owner->GetComponents().Num() : 0;
+
+	if (animationTargetsDirty == false && animationTargetsComponentCount == ownerComponentCount)
+	{
+		return animationTargets;
+	}
+
+	ReleaseAnimationTargets();
+
+	if (owner != nullptr)
+	{
+		TInlineComponentArray<USkeletalMeshComponent*> skeletalMeshComponents(owner);
+		for (USkeletalMeshComponent* skeletalMeshComponent : skeletalMeshComponents)
+		{
+			// Watch every mesh, so that a mesh getting its anim instance later is picked up
+			skeletalMeshComponent->OnAnimInitialized.AddUniqueDynamic(this, &UComboComponent::OnAnimationTargetInitialized);
+			animationTargetMeshes.Add(skeletalMeshComponent);
+
+			UAnimInstance* animInstance = skeletalMeshComponent->GetAnimInstance();
+			if (animInstance == nullptr)
+			{
+				continue;
+			}
+
+			animInstance->OnMontageBlendingOut.AddUniqueDynamic(this, &UComboComponent::OnAttackAnimationEnded);
+			animationTargets.Add(animInstance);
+		}
+	}
+
+	animationTargetsComponentCount = ownerComponentCount;
+	animationTargetsDirty = false;
+	return animationTargets;
+}
+
+void UComboComponent::ReleaseAnimationTargets()
+{
+	for (const TWeakObjectPtr<UAnimInstance>& animationTarget : animationTargets)
+	{
+		if (UAnimInstance* animInstance = animationTarget.Get())
+		{
+			animInstance->OnMontageBlendingOut.RemoveDynamic(this, &UComboComponent::OnAttackAnimationEnded);
+		}
+	}
+
+	for (const TWeakObjectPtr<USkeletalMeshComponent>& animationTargetMesh : animationTargetMeshes)
+	{
+		if (USkeletalMeshComponent* skeletalMeshComponent = animationTargetMesh.Get())
+		{
+			skeletalMeshComponent->OnAnimInitialized.RemoveDynamic(this, &UComboComponent::OnAnimationTargetInitialized);
+		}
+	}
+
+	animationTargets.Reset();
+	animationTargetMeshes.Reset();
+	animationTargetsComponentCount = INDEX_NONE;
+	animationTargetsDirty = true;
 }
 
 // Called when the game starts
@@ -26,7 +218,14 @@ void UComboComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if (moveSet == nullptr)
+	// Hand our timers over to the world's combo subsystem
+	comboSubsystem = GetWorld()->GetSubsystem<UComboWorldSubsystem>();
+	if (comboSubsystem != nullptr)
+	{
+		comboSlot = comboSubsystem->RegisterComponent(this);
+	}
+
+	if (HasMoveSet() == false)
 	{
 #if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
 		// Debugging messages
@@ -39,53 +238,527 @@ void UComboComponent::BeginPlay()
 		return;
 	}
 
-	// Init moveset graph
-	moveSetGraph = *(new ComboGraph());
-	moveSetGraph.CreateComboGraph(moveSet);
+	// Init moveset graph. Components sharing the same moveset share the same compiled graph.
+	AcquireMoveSetGraph();
+}
+
+bool UComboComponent::AcquireMoveSetGraph()
+{
+	const FComboStaticMovesetTable* staticMoveSetTable = ComboStaticMovesetRegistry::Find(staticMoveSet);
+	if (switchableMoveSets.Num() > 0)
+	{
+		moveSetLibrary = ComboGraphCache::AcquireLibrary(switchableMoveSets);
+		activeMoveSetIndex = moveSetLibrary.IsValid() ? FMath::Clamp(activeMoveSetIndex, 0, moveSetLibrary->GetNumMoveSets() - 1) : 0;
+		moveSetGraph = moveSetLibrary.IsValid() ? moveSetLibrary->GetGraph(activeMoveSetIndex) : nullptr;
+		rollbackState.moveSetIndex = static_cast<uint8>(activeMoveSetIndex);
+	}
+	else if (staticMoveSetTable != nullptr)
+	{
+		moveSetGraph = ComboGraphCache::Acquire(staticMoveSetTable);
+	}
+	else if (compiledMoveSet != nullptr)
+	{
+		moveSetGraph = ComboGraphCache::Acquire(compiledMoveSet);
+	}
+	else
+	{
+		moveSetGraph = ComboGraphCache::Acquire(moveSet);
+	}
+
+	// Node indices of the previous graph mean nothing in the new one
+	ReleaseMontagePrefetch();
+	UpdateMontagePrefetch();
+
+	// Clients have the same graph, so node indices are sent with just enough bits for its node count, or for the largest graph the component can switch to
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		int32 maxNodeCount = moveSetGraph.IsValid() ? moveSetGraph->GetNodeCount() : 0;
+		for (int32 moveSetIndex = 0; moveSetLibrary.IsValid() && moveSetIndex < moveSetLibrary->GetNumMoveSets(); moveSetIndex++)
+		{
+			maxNodeCount = FMath::Max(maxNodeCount, moveSetLibrary->GetGraph(moveSetIndex)->GetNodeCount());
+		}
+		replicatedComboState.nodeIndexBits = maxNodeCount > 0 ? static_cast<uint8>(FMath::CeilLogTwo(static_cast<uint32>(maxNodeCount))) : 0;
+		replicatedComboState.moveSetIndex = static_cast<uint8>(activeMoveSetIndex);
+	}
+
+	return moveSetGraph.IsValid();
+}
+
+void UComboComponent::SetActiveMoveSet(int32 moveSetIndex)
+{
+	activeMoveSetIndex = moveSetIndex;
+	moveSetGraph = moveSetLibrary->GetGraph(moveSetIndex);
+	rollbackState.moveSetIndex = static_cast<uint8>(moveSetIndex);
+
+	// A montage still loading was looked up by a node of the previous graph
+	CancelPendingAttackAnimation();
+
+	// Node indices of the previous graph mean nothing in the new one. The prefetch requests the new montages before releasing the old ones, so montages both movesets use stay loaded.
+	montagePrefetchNodeIndex = INDEX_NONE;
+	UpdateMontagePrefetch();
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		replicatedComboState.moveSetIndex = static_cast<uint8>(moveSetIndex);
+	}
 }
 
+bool UComboComponent::SwitchMoveSet(int32 moveSetIndex)
+{
+	const bool switched = ApplyMoveSetSwitch(moveSetIndex);
+
+	// Replays switch at the same point of the input stream, so that the inputs after the switch are resolved by the same moveset
+	if (switched && comboSubsystem != nullptr)
+	{
+		comboSubsystem->RecordMoveSetSwitch(this, moveSetIndex);
+	}
 
-// Called every frame
-void UComboComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+	return switched;
+}
+
+bool UComboComponent::ApplyMoveSetSwitch(int32 moveSetIndex)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	// Simulated proxies follow the moveset the server replicates. Fixed step components switch through SimulateFrame, so that the switch belongs to a simulated frame
+	// and rollback restores and resimulates it with the attack inputs.
+	if (switchableMoveSets.Num() == 0 || GetOwnerRole() == ROLE_SimulatedProxy || fixedStepSimulation || (moveSetGraph.IsValid() == false && AcquireMoveSetGraph() == false))
+	{
+		return false;
+	}
+
+	// The index is replicated in a byte
+	if (moveSetLibrary.IsValid() == false || moveSetIndex < 0 || moveSetIndex >= moveSetLibrary->GetNumMoveSets() || moveSetIndex > MAX_uint8)
+	{
+		return false;
+	}
+
+	if (moveSetIndex == activeMoveSetIndex)
+	{
+		return true;
+	}
+
+	// The server applies the switch in order with the attack inputs sent before it
+	if (GetOwnerRole() == ROLE_AutonomousProxy)
+	{
+		ServerSwitchMoveSet(static_cast<uint8>(moveSetIndex));
+	}
 
-	// Increase variable for time elapsed since the last input was received
-	timeSinceLastAttackInput += DeltaTime;
+	const EComboMissPolicy switchMissPolicy = GetMissPolicy();
+	const int32 mappedNodeIndex = moveSetLibrary->MapCursor(activeMoveSetIndex, moveSetIndex, comboCursor.nodeIndex, switchMissPolicy);
+	const bool comboBroken = comboCursor.IsAtRoot() == false && mappedNodeIndex == 0;
 
-	// Check if the attack cooldown is currently active
-	// Do this before checking if the combo sequence should reset otherwise we end up adding delta time to it on the same frame that the cooldown has been activated
-	if (canAttack == false)
+	if (comboBroken)
+	{
+		// A chain the new moveset does not have is broken like a missed input. Reset while the cursor still refers to the previous graph.
+		RecordComboEvent(EComboTraceEventType::Miss, comboCursor.nodeIndex, GetComboDepth());
+		ResetComboSequence(false);
+	}
+	else
 	{
-		// No point increasing the attack recovery timer if we can already attack so we do it inside this 'if' block
-		attackRecoveryCooldownTimer += DeltaTime;
+		comboCursor.nodeIndex = mappedNodeIndex;
+		if (mappedNodeIndex != 0)
+		{
+			SetReplicatedComboState(mappedNodeIndex, false);
+		}
 
-		if (attackRecoveryCooldownTimer >= attackRecoveryCooldown)
+		// A queued attack moves to its own chain in the new moveset, or is dropped if that chain is missing
+		if (queuedAttackNodeIndex != INDEX_NONE)
 		{
-			canAttack = true;
-			attackRecoveryCooldownTimer = 0.0f;
+			const int32 mappedQueuedNodeIndex = moveSetLibrary->MapCursor(activeMoveSetIndex, moveSetIndex, queuedAttackNodeIndex, switchMissPolicy);
+			queuedAttackNodeIndex = mappedQueuedNodeIndex != 0 ? mappedQueuedNodeIndex : INDEX_NONE;
+		}
+	}
+
+	SetActiveMoveSet(moveSetIndex);
+
+	const FComboGraphNode* mappedNode = moveSetGraph->GetNode(comboCursor.nodeIndex);
+	RecordComboEvent(EComboTraceEventType::MoveSetSwitched, comboCursor.nodeIndex, mappedNode != nullptr ? mappedNode->depth : 0, static_cast<uint8>(moveSetIndex));
 
 #if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
-			// Debugging messages
-			if (GEngine)
-			{
-				GEngine->AddOnScreenDebugMessage(1, 1.0f, FColor::Yellow, TEXT("Attack recovery cooldown timer has completed"));
-			}
+	// Debugging messages
+	if (GEngine && ComboMetrics::ShowDebugMessages())
+	{
+		GEngine->AddOnScreenDebugMessage(0, 1.5f, FColor::Yellow, FString::Printf(TEXT("Switched to moveset %d"), moveSetIndex));
+	}
 #endif
+
+	return true;
+}
+
+void UComboComponent::ServerSwitchMoveSet_Implementation(uint8 moveSetIndex)
+{
+	ApplyMoveSetSwitch(moveSetIndex);
+}
+
+void UComboComponent::UpdateMontagePrefetch()
+{
+	if (moveSetGraph.IsValid() == false || montagePrefetchNodeIndex == comboCursor.nodeIndex)
+	{
+		return;
+	}
+
+	montagePrefetchNodeIndex = comboCursor.nodeIndex;
+
+	// The scratch arrays keep their memory between inputs, so that gathering the montages does not allocate once they have grown to the moveset's size
+	prefetchReachableNodeIndices.Reset();
+	moveSetGraph->GetReachableNodeIndices(comboCursor.nodeIndex, 1 + FMath::Max(0, montagePrefetchLookahead), prefetchReachableNodeIndices);
+
+	prefetchMontagePaths.Reset();
+	for (const int32 reachableNodeIndex : prefetchReachableNodeIndices)
+	{
+		const TSoftObjectPtr<UAnimMontage>& attackAnimation = moveSetGraph->GetMoveData(moveSetGraph->GetNode(reachableNodeIndex)).attackAnimation;
+		if (attackAnimation.IsNull() == false)
+		{
+			prefetchMontagePaths.AddUnique(attackAnimation.ToSoftObjectPath());
 		}
 	}
 
-	// Check if current sequence should be reset because the player took too long to perform the next attack in the chain
-	else if (timeSinceLastAttackInput >= timeBeforeComboReset)
+	// Attacks often lead to the same montages as the previous one, such as a loop of light attacks. The montages already requested stay loaded as they are.
+	bool samePaths = prefetchMontagePaths.Num() == requestedMontagePaths.Num();
+	for (int32 pathIndex = 0; samePaths && pathIndex < prefetchMontagePaths.Num(); pathIndex++)
+	{
+		samePaths = requestedMontagePaths.Contains(prefetchMontagePaths[pathIndex]);
+	}
+	if (samePaths)
+	{
+		return;
+	}
+	requestedMontagePaths.Reset();
+	requestedMontagePaths.Append(prefetchMontagePaths);
+
+	// Request the new montages before releasing the old ones, so that montages reachable from both nodes stay loaded
+	TSharedPtr<FStreamableHandle> previousPrefetchHandle = MoveTemp(montagePrefetchHandle);
+
+	if (prefetchMontagePaths.Num() > 0)
+	{
+		montagePrefetchHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(prefetchMontagePaths, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+	}
+
+	if (previousPrefetchHandle.IsValid())
+	{
+		previousPrefetchHandle->ReleaseHandle();
+	}
+}
+
+void UComboComponent::ReleaseMontagePrefetch()
+{
+	if (montagePrefetchHandle.IsValid())
+	{
+		montagePrefetchHandle->ReleaseHandle();
+		montagePrefetchHandle.Reset();
+	}
+	montagePrefetchNodeIndex = INDEX_NONE;
+	requestedMontagePaths.Reset();
+}
+
+void UComboComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Release our handle on the shared graph. The graph is freed once no other component uses it.
+	ReleaseMontagePrefetch();
+	CancelPendingAttackAnimation();
+	moveSetGraph.Reset();
+	moveSetLibrary.Reset();
+	comboCursor.Reset();
+	rollbackState = FComboRollbackState();
+	ReleaseAnimationTargets();
+	playingAttackAnimation = nullptr;
+	ClearComboWindows();
+
+	if (comboSubsystem != nullptr && comboSlot != INDEX_NONE)
+	{
+		comboSubsystem->UnregisterComponent(comboSlot);
+	}
+	comboSubsystem = nullptr;
+	comboSlot = INDEX_NONE;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+EComboMissPolicy UComboComponent::GetMissPolicy() const
+{
+	return compiledMoveSet != nullptr ? compiledMoveSet->missPolicy : missPolicy;
+}
+
+bool UComboComponent::CanAttack() const
+{
+	if (fixedStepSimulation)
+	{
+		return rollbackState.attackCooldownFrames == 0;
+	}
+
+	return comboSubsystem != nullptr && comboSlot != INDEX_NONE && comboSubsystem->CanAttack(comboSlot);
+}
+
+const FComboGraphNode* UComboComponent::GetLastPerformedAttack() const
+{
+	return comboCursor.IsAtRoot() == false && moveSetGraph.IsValid() ? moveSetGraph->GetNode(comboCursor.nodeIndex) : nullptr;
+}
+
+int32 UComboComponent::GetComboDepth() const
+{
+	const FComboGraphNode* lastPerformedAttack = GetLastPerformedAttack();
+	return lastPerformedAttack != nullptr ? lastPerformedAttack->depth : 0;
+}
+
+bool UComboComponent::IsReadyForAttackInput() const
+{
+	if (CanAttack() == false)
 	{
-		//ResetComboSequence();
+		return false;
 	}
+
+	// Attacks with combo windows only take one input, and only while one of their windows is open
+	return attackUsesComboWindows == false || (queuedAttackNodeIndex == INDEX_NONE && (acceptInputWindowOpen || cancelWindowOpen));
 }
 
 void UComboComponent::AttackInput(AttackType_Enum attackType)
+{
+	ProcessAttackInput(attackType, FPlatformTime::Seconds());
+}
+
+void UComboComponent::ProcessAttackInput(AttackType_Enum attackType, double inputTimestamp)
+{
+	switch (GetOwnerRole())
+	{
+	case ROLE_AutonomousProxy:
+		PredictAttackInput(attackType, inputTimestamp);
+		break;
+	case ROLE_SimulatedProxy:
+		// Other players' combos come from the server
+		RecordComboEvent(EComboTraceEventType::InputIgnored, comboCursor.nodeIndex, 0, static_cast<uint8>(attackType));
+		break;
+	default:
+		ResolveAttackInput(attackType, inputTimestamp);
+		break;
+	}
+
+	// Direct, buffered and deferred batch inputs all end up here, so each of them is recorded once it has been processed
+	if (comboSubsystem != nullptr)
+	{
+		comboSubsystem->RecordAttackInput(this, static_cast<uint8>(attackType));
+	}
+}
+
+void UComboComponent::PredictAttackInput(AttackType_Enum attackType, double inputTimestamp)
+{
+	// Perform the attack right away, the server confirms or corrects it once it has resolved the input
+	FComboPredictedInput predictedInput;
+	predictedInput.accepted = ResolveAttackInput(attackType, inputTimestamp);
+	predictedInput.queued = predictedInput.accepted && queuedAttackNodeIndex != INDEX_NONE;
+	predictedInput.attackInput = static_cast<uint8>(attackType);
+
+	predictedInputSequence = (predictedInputSequence + 1) & FComboReplicatedState::InputSequenceMask;
+	predictedInput.inputSequence = predictedInputSequence;
+
+	// Older predictions would no longer compare correctly against the server's sequence number
+	if (pendingPredictedInputs.Num() == MaxPendingPredictedInputs)
+	{
+		pendingPredictedInputs.RemoveAt(0, 1, false);
+	}
+	pendingPredictedInputs.Add(predictedInput);
+
+	ServerAttackInput(predictedInput.attackInput, predictedInput.inputSequence);
+}
+
+void UComboComponent::ServerAttackInput_Implementation(uint8 attackInput, uint8 inputSequence)
+{
+	ResolveAttackInput(static_cast<AttackType_Enum>(attackInput), FPlatformTime::Seconds());
+
+	// Acknowledge the input even if it was ignored, so that the client stops replaying its prediction
+	replicatedComboState.inputSequence = inputSequence & FComboReplicatedState::InputSequenceMask;
+}
+
+void UComboComponent::SetReplicatedComboState(int32 attackNodeIndex, bool comboEnded)
+{
+	if (GetOwnerRole() != ROLE_Authority)
+	{
+		return;
+	}
+
+	replicatedComboState.attackNodeIndex = attackNodeIndex;
+	replicatedComboState.comboEnded = comboEnded;
+}
+
+void UComboComponent::OnRep_ReplicatedComboState(const FComboReplicatedState& previousState)
+{
+	if (GetOwnerRole() == ROLE_AutonomousProxy)
+	{
+		ReconcilePredictedInputs();
+		return;
+	}
+
+	if (moveSetGraph.IsValid() == false && AcquireMoveSetGraph() == false)
+	{
+		return;
+	}
+
+	// The server's node indices refer to the graph of its moveset. Its cursor was already mapped when it switched, so the graph is only swapped here.
+	const bool moveSetSwitched = moveSetLibrary.IsValid() && replicatedComboState.moveSetIndex != activeMoveSetIndex && replicatedComboState.moveSetIndex < moveSetLibrary->GetNumMoveSets();
+	if (moveSetSwitched)
+	{
+		SetActiveMoveSet(replicatedComboState.moveSetIndex);
+		const FComboGraphNode* cursorNode = moveSetGraph->GetNode(replicatedComboState.GetCursorNodeIndex());
+		RecordComboEvent(EComboTraceEventType::MoveSetSwitched, replicatedComboState.GetCursorNodeIndex(), cursorNode != nullptr ? cursorNode->depth : 0, replicatedComboState.moveSetIndex);
+	}
+
+	// A new attack count means the server performed an attack since the last update. Misses, queued inputs and moveset switches do not count.
+	const FComboGraphNode* attackNode = replicatedComboState.attackNodeIndex != 0 ? moveSetGraph->GetNode(replicatedComboState.attackNodeIndex) : nullptr;
+	const bool attackPerformed = attackNode != nullptr && replicatedComboState.attackCounter != previousState.attackCounter;
+
+	if (attackPerformed)
+	{
+		RecordComboEvent(EComboTraceEventType::NodeAdvanced, replicatedComboState.attackNodeIndex, attackNode->depth);
+		PlayAttackAnimation(attackNode);
+	}
+
+	const int32 cursorNodeIndex = replicatedComboState.GetCursorNodeIndex();
+	comboCursor.nodeIndex = moveSetGraph->GetNode(cursorNodeIndex) != nullptr ? cursorNodeIndex : 0;
+	UpdateMontagePrefetch();
+
+	if (replicatedComboState.comboEnded && (previousState.comboEnded == false || attackPerformed))
+	{
+		COMBO_PHASE_SCOPE(DelegateBroadcast);
+		OnComboBrokenDelegate.Broadcast();
+	}
+}
+
+void UComboComponent::ReconcilePredictedInputs()
+{
+	// Every input up to the last one the server resolved is settled, whatever the outcome
+	const uint8 resolvedInputSequence = replicatedComboState.inputSequence;
+	pendingPredictedInputs.RemoveAll([resolvedInputSequence](const FComboPredictedInput& predictedInput)
+	{
+		return FComboReplicatedState::GetInputSequenceDelta(predictedInput.inputSequence, resolvedInputSequence) <= 0;
+	});
+
+	// Until the server has applied this client's last moveset switch, its node indices refer to another graph. The switch is reliable, so a later update will match.
+	if (moveSetGraph.IsValid() == false || (moveSetLibrary.IsValid() && replicatedComboState.moveSetIndex != activeMoveSetIndex))
+	{
+		return;
+	}
+
+	// Replay the inputs the server has not resolved yet on top of its state, the same way they were resolved when they were predicted
+	FComboGraphCursor reconciledCursor;
+	const int32 serverCursorNodeIndex = replicatedComboState.GetCursorNodeIndex();
+	reconciledCursor.nodeIndex = moveSetGraph->GetNode(serverCursorNodeIndex) != nullptr ? serverCursorNodeIndex : 0;
+
+	int32 reconciledQueuedNodeIndex = INDEX_NONE;
+	for (const FComboPredictedInput& predictedInput : pendingPredictedInputs)
+	{
+		if (predictedInput.accepted == false)
+		{
+			continue;
+		}
+
+		FComboGraphCursor resolvedCursor = reconciledCursor;
+		const FComboGraphNode* attackToPerform = moveSetGraph->AdvanceCursor(resolvedCursor, predictedInput.attackInput, GetMissPolicy());
+		if (attackToPerform == nullptr)
+		{
+			reconciledCursor.Reset();
+			reconciledQueuedNodeIndex = INDEX_NONE;
+			continue;
+		}
+
+		// A queued attack waits for the cancel window, the cursor stays on the attack that is playing
+		if (predictedInput.queued)
+		{
+			reconciledQueuedNodeIndex = resolvedCursor.nodeIndex;
+			continue;
+		}
+
+		reconciledCursor = resolvedCursor;
+		if (attackToPerform->childCount < 1)
+		{
+			reconciledCursor.Reset();
+		}
+	}
+
+	if (reconciledCursor.nodeIndex == comboCursor.nodeIndex)
+	{
+		// Only the queued attack differs, which is followed without cutting short the attack that is playing
+		if (queuedAttackNodeIndex != INDEX_NONE && reconciledQueuedNodeIndex != INDEX_NONE)
+		{
+			queuedAttackNodeIndex = reconciledQueuedNodeIndex;
+		}
+		return;
+	}
+
+	// The prediction was wrong, follow the server. The montage already playing is left to finish.
+	const FComboGraphNode* reconciledNode = moveSetGraph->GetNode(reconciledCursor.nodeIndex);
+	RecordComboEvent(EComboTraceEventType::PredictionCorrected, reconciledCursor.nodeIndex, reconciledNode != nullptr ? reconciledNode->depth : 0, resolvedInputSequence);
+
+	comboCursor = reconciledCursor;
+	ClearComboWindows();
+	UpdateMontagePrefetch();
+}
+
+bool UComboComponent::BufferAttackInput(AttackType_Enum attackType)
+{
+	return BufferAttackInputAtTime(attackType, FPlatformTime::Seconds());
+}
+
+bool UComboComponent::BufferAttackInputAtTime(AttackType_Enum attackType, double timestamp)
+{
+	if (bufferAttackInputs == false)
+	{
+		return false;
+	}
+
+	FComboBufferedAttackInput bufferedInput;
+	bufferedInput.timestamp = timestamp;
+	bufferedInput.attackType = attackType;
+	return inputBuffer.Enqueue(bufferedInput);
+}
+
+void UComboComponent::DrainInputBuffer()
+{
+	const double currentTime = FPlatformTime::Seconds();
+
+	while (const FComboBufferedAttackInput* bufferedInput = inputBuffer.Peek())
+	{
+		// The press was too early to be kept any longer
+		if (currentTime - bufferedInput->timestamp > inputBufferWindow)
+		{
+			inputBuffer.Dequeue();
+			continue;
+		}
+
+		// Keep the input, and the ones after it, until the actor can attack again or the next combo window opens
+		if (IsReadyForAttackInput() == false)
+		{
+			return;
+		}
+
+		const FComboBufferedAttackInput input = *bufferedInput;
+		inputBuffer.Dequeue();
+
+		ProcessAttackInput(input.attackType, input.timestamp);
+	}
+}
+
+bool UComboComponent::ResolveAttackInput(AttackType_Enum attackType, double inputTimestamp)
+{
+	if (PrepareAttackInput(attackType) == false)
+	{
+		return false;
+	}
+
+	// Move the combo cursor one edge along the combo graph from the last performed attack to figure out which move to perform
+	FComboGraphCursor resolvedCursor = comboCursor;
+	const FComboGraphNode* attackToPerform = nullptr;
+	{
+		COMBO_PHASE_SCOPE(AttackLookup);
+		attackToPerform = moveSetGraph->AdvanceCursor(resolvedCursor, attackType, GetMissPolicy());
+	}
+
+	CommitAttackInput(attackToPerform, resolvedCursor, inputTimestamp);
+	return true;
+}
+
+bool UComboComponent::PrepareAttackInput(AttackType_Enum attackType)
 {
 
-	if (moveSet == nullptr)
+	if (HasMoveSet() == false)
 	{
 #if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
 		// Debugging messages
@@ -96,97 +769,247 @@ void UComboComponent::AttackInput(AttackType_Enum attackType)
 #endif
 
 		//Do not attempt attack without moveset table
-		return;
+		RecordComboEvent(EComboTraceEventType::InputIgnored, comboCursor.nodeIndex, 0, static_cast<uint8>(attackType));
+		return false;
+
+	}
+
+	// Fixed step components only take inputs through SimulateFrame, so that every input belongs to a simulated frame
+	if (fixedStepSimulation)
+	{
+		RecordComboEvent(EComboTraceEventType::InputIgnored, comboCursor.nodeIndex, 0, static_cast<uint8>(attackType));
+		return false;
+	}
 
+	// The moveset may have been assigned after BeginPlay
+	//Do not attempt attack if the moveset could not be turned into a graph
+	if (moveSetGraph.IsValid() == false && AcquireMoveSetGraph() == false)
+	{
+		RecordComboEvent(EComboTraceEventType::InputIgnored, comboCursor.nodeIndex, 0, static_cast<uint8>(attackType));
+		return false;
 	}
 
 
 #if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
 	// Debugging messages
-	if (GEngine)
+	if (GEngine && ComboMetrics::ShowDebugMessages())
 	{
-		GEngine->AddOnScreenDebugMessage(9, 1.5f, FColor::Yellow, TEXT("Attempting Attack: " + attackType));
+		GEngine->AddOnScreenDebugMessage(9, 1.5f, FColor::Yellow, FString::Printf(TEXT("Attempting Attack: %d"), static_cast<int32>(attackType)));
 	}
 #endif
 
 	// Do nothing if the player cannot attack right now
-	if (canAttack == false)
-	{
-		return;
-	}
-
+	const bool inputAccepted = IsReadyForAttackInput();
+	RecordComboEvent(inputAccepted ? EComboTraceEventType::InputReceived : EComboTraceEventType::InputIgnored, comboCursor.nodeIndex, 0, static_cast<uint8>(attackType));
+	return inputAccepted;
+}
 
-	// Evaluate current combo sequence with respect to combo graph to figure out which move to perform
-	currentComboSequence.Add(attackType);
+void UComboComponent::CommitAttackInput(const FComboGraphNode* attackToPerform, const FComboGraphCursor& resolvedCursor, double inputTimestamp)
+{
+	lastAttackInputTimestamp = inputTimestamp;
 
-	FComboGraphNode* attackToPerform = nullptr;
-	if (lastPerformedAttack == nullptr)
-	{
-		attackToPerform = moveSetGraph.FastFindNodeWithAttackChain(currentComboSequence);
-	}
-	else
-	{
-		attackToPerform = moveSetGraph.FastFindNodeWithLastPerformedAttack(currentComboSequence, lastPerformedAttack);
-	}
+	ComboMetrics::RecordAttackLookup(attackToPerform != nullptr, attackToPerform != nullptr ? resolvedCursor.nodeIndex : INDEX_NONE, attackToPerform != nullptr ? attackToPerform->depth : 0);
 
 	// Check if move is not found
 	if (attackToPerform == nullptr)
 	{
+		RecordComboEvent(EComboTraceEventType::Miss, comboCursor.nodeIndex, GetComboDepth());
+
 		// Reset the combo sequence because invalid move chain
-		ResetComboSequence();
+		ResetComboSequence(false);
 
 		// Don't process the rest
 		return;
 	}
 
+	// The input did not continue the chain, but the combo carries on from a shorter chain ending with it
+	if (attackToPerform->parentIndex != comboCursor.nodeIndex)
+	{
+		RecordComboEvent(EComboTraceEventType::ComboResumed, resolvedCursor.nodeIndex, attackToPerform->depth, static_cast<uint8>(FMath::Min(GetComboDepth(), int32(MAX_uint8))));
+	}
+
+	// An input taken in an accept input window waits until the current attack can be cancelled
+	if (attackUsesComboWindows && cancelWindowOpen == false)
+	{
+		queuedAttackNodeIndex = resolvedCursor.nodeIndex;
+		RecordComboEvent(EComboTraceEventType::AttackQueued, resolvedCursor.nodeIndex, attackToPerform->depth);
+		return;
+	}
+
+	PerformAttack(attackToPerform, resolvedCursor);
+}
+
+void UComboComponent::PerformQueuedAttack()
+{
+	FComboGraphCursor resolvedCursor;
+	resolvedCursor.nodeIndex = queuedAttackNodeIndex;
+	const FComboGraphNode* attackToPerform = moveSetGraph->GetNode(queuedAttackNodeIndex);
+	queuedAttackNodeIndex = INDEX_NONE;
+
+	// The prediction that queued the attack has now performed it, and moves the cursor when replayed
+	for (int32 predictedInputIndex = pendingPredictedInputs.Num() - 1; predictedInputIndex >= 0; predictedInputIndex--)
+	{
+		if (pendingPredictedInputs[predictedInputIndex].queued)
+		{
+			pendingPredictedInputs[predictedInputIndex].queued = false;
+			break;
+		}
+	}
+
+	PerformAttack(attackToPerform, resolvedCursor);
+}
+
+void UComboComponent::PerformAttack(const FComboGraphNode* attackToPerform, const FComboGraphCursor& resolvedCursor)
+{
 #if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
 	// Debugging messages
-	if (GEngine)
+	if (GEngine && ComboMetrics::ShowDebugMessages())
 	{
-		GEngine->AddOnScreenDebugMessage(0, 1.5f, FColor::Yellow, TEXT("Performing Attack: " + attackToPerform->attackData->moveName));
+		GEngine->AddOnScreenDebugMessage(0, 1.5f, FColor::Yellow, TEXT("Performing Attack: " + moveSetGraph->GetMoveData(attackToPerform).moveName));
 	}
 #endif
 
 
-	TArray<USkeletalMeshComponent*> Components;
-	AActor* Actor = GetOwner();
-	Actor->GetComponents<USkeletalMeshComponent>(Components);
-	for (int32 i = 0; i < Components.Num(); i++)
+	comboCursor = resolvedCursor;
+	SetReplicatedComboState(resolvedCursor.nodeIndex, false);
+
+	// Only attacks that are actually performed count for the clients, not misses or inputs queued in a window
+	if (GetOwnerRole() == ROLE_Authority)
 	{
-		USkeletalMeshComponent* skeletalMeshComponent = Components[i];
-		UAnimInstance* SkeletalMeshAnimInstance = skeletalMeshComponent->GetAnimInstance();		
-		SkeletalMeshAnimInstance->Montage_Play(attackToPerform->attackData->attackAnimation);
+		replicatedComboState.attackCounter = (replicatedComboState.attackCounter + 1) & FComboReplicatedState::AttackCounterMask;
+	}
+	RecordComboEvent(EComboTraceEventType::NodeAdvanced, resolvedCursor.nodeIndex, attackToPerform->depth);
 
+	PlayAttackAnimation(attackToPerform);
 
-		FOnMontageEnded blendOutDel;
-		blendOutDel.BindUObject(this, &UComboComponent::OnAttackAnimationEnded);
-		SkeletalMeshAnimInstance->Montage_SetBlendingOutDelegate(blendOutDel);
-		
-		//SkeletalMeshAnimInstance->OnMontageBlendingOut.Add(OnAttackAnimationEnded);
+	// Attacks with combo windows end their chain when their montage blends out, the others when no input is received in time
+	if (attackUsesComboWindows)
+	{
+		comboSubsystem->CancelComboReset(comboSlot);
 	}
+	else
+	{
+		comboSubsystem->NotifyAttackInput(comboSlot, timeBeforeComboReset);
+	}
+
+	// Stream in the montages of the attacks that can follow this one
+	UpdateMontagePrefetch();
 
 	//check if that was the last possible attack in its chain and activate the recovery cooldown if it is
-	if (attackToPerform->childrenNodes.Num() < 1)
+	if (attackToPerform->childCount < 1)
+	{
+		ResetComboSequence(true);
+	}
+}
+
+void UComboComponent::RecordComboEvent(EComboTraceEventType type, int32 nodeIndex, int32 depth, uint8 payload) const
+{
+	if (comboSubsystem != nullptr)
+	{
+		comboSubsystem->RecordEvent(type, this, nodeIndex, depth, payload);
+	}
+}
+
+void UComboComponent::PlayAttackAnimation(const FComboGraphNode* attackToPerform)
+{
+	COMBO_PHASE_SCOPE(MontageDispatch);
+
+	// A new attack starts with its windows closed, they are opened by its montage's notifies. It also replaces an attack whose montage is still loading.
+	ClearComboWindows();
+	CancelPendingAttackAnimation();
+
+	// Montages are soft references, normally already streamed in by the prefetch of the previous node. The game thread never waits for one:
+	// if the prefetch has not finished, the montage is requested ahead of everything else and played once it arrives.
+	const TSoftObjectPtr<UAnimMontage>& attackAnimationReference = moveSetGraph->GetMoveData(attackToPerform).attackAnimation;
+	UAnimMontage* attackAnimation = attackAnimationReference.Get();
+	if (attackAnimation == nullptr)
+	{
+		if (attackAnimationReference.IsNull() == false)
+		{
+			pendingAttackAnimationNodeIndex = moveSetGraph->GetNodeIndex(attackToPerform);
+			pendingAttackAnimationHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(attackAnimationReference.ToSoftObjectPath(),
+				FStreamableDelegate::CreateUObject(this, &UComboComponent::OnPendingAttackAnimationLoaded), PendingAttackAnimationPriority);
+		}
+		return;
+	}
+
+	StartAttackAnimation(attackToPerform, attackAnimation);
+}
+
+void UComboComponent::OnPendingAttackAnimationLoaded()
+{
+	const FComboGraphNode* attackNode = moveSetGraph.IsValid() ? moveSetGraph->GetNode(pendingAttackAnimationNodeIndex) : nullptr;
+	UAnimMontage* attackAnimation = attackNode != nullptr ? moveSetGraph->GetMoveData(attackNode).attackAnimation.Get() : nullptr;
+	CancelPendingAttackAnimation();
+
+	if (attackAnimation == nullptr)
+	{
+		return;
+	}
+
+	StartAttackAnimation(attackNode, attackAnimation);
+
+	// The attack was waiting on the reset timer, its windows take over now that its montage is known to have them
+	if (attackUsesComboWindows && comboCursor.IsAtRoot() == false && comboSubsystem != nullptr && comboSlot != INDEX_NONE)
+	{
+		comboSubsystem->CancelComboReset(comboSlot);
+	}
+}
+
+void UComboComponent::CancelPendingAttackAnimation()
+{
+	if (pendingAttackAnimationHandle.IsValid())
 	{
-		ResetComboSequence();
+		pendingAttackAnimationHandle->ReleaseHandle();
+		pendingAttackAnimationHandle.Reset();
+	}
+	pendingAttackAnimationNodeIndex = INDEX_NONE;
+}
+
+void UComboComponent::StartAttackAnimation(const FComboGraphNode* attackToPerform, UAnimMontage* attackAnimation)
+{
+	// Windows depend on animation playback, which fixed-step simulation does not resimulate. Simulated proxies follow the server's combo instead of their own windows.
+	attackUsesComboWindows = fixedStepSimulation == false && GetOwnerRole() != ROLE_SimulatedProxy && UComboWindowNotifyState::HasComboWindows(attackAnimation);
+	playingAttackAnimation = attackAnimation;
+	RecordComboEvent(EComboTraceEventType::MontageStarted, moveSetGraph->GetNodeIndex(attackToPerform), attackToPerform->depth);
+
+	for (const TWeakObjectPtr<UAnimInstance>& animationTarget : GetAnimationTargets())
+	{
+		if (UAnimInstance* animInstance = animationTarget.Get())
+		{
+			animInstance->Montage_Play(attackAnimation);
+		}
 	}
 }
 
-void UComboComponent::ResetComboSequence()
+void UComboComponent::ResetComboSequence(bool comboCompleted)
 {
+	const FComboGraphNode* lastPerformedAttack = GetLastPerformedAttack();
+	if (lastPerformedAttack != nullptr)
+	{
+		ComboMetrics::RecordComboEnded(comboCompleted, lastPerformedAttack->depth);
+	}
+	RecordComboEvent(EComboTraceEventType::ComboReset, comboCursor.nodeIndex, GetComboDepth(), comboCompleted ? 1 : 0);
+
+	// The attack node is kept for a completed combo, so that clients still see its last attack
+	SetReplicatedComboState(comboCompleted ? comboCursor.nodeIndex : 0, true);
+
 	// Clear the current combo sequence
-	currentComboSequence.Empty();
+	comboCursor.Reset();
+	ClearComboWindows();
+	UpdateMontagePrefetch();
 
 	// Activate cooldown for attacks
 	ActivateAttackCooldown();
 
-	OnComboBrokenDelegate.Broadcast();
-
-	lastPerformedAttack = nullptr;
+	{
+		COMBO_PHASE_SCOPE(DelegateBroadcast);
+		OnComboBrokenDelegate.Broadcast();
+	}
 
 #if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
 	// Debugging messages
-	if (GEngine)
+	if (GEngine && ComboMetrics::ShowDebugMessages())
 	{
 		GEngine->AddOnScreenDebugMessage(0, 1.5f, FColor::Yellow, TEXT("Combo Sequence has been reset"));
 	}
@@ -195,6 +1018,162 @@ void UComboComponent::ResetComboSequence()
 
 void UComboComponent::ActivateAttackCooldown()
 {
-	canAttack = false;
-	attackRecoveryCooldownTimer = 0.0f;
-}
\ No newline at end of file
+	if (comboSubsystem != nullptr && comboSlot != INDEX_NONE)
+	{
+		comboSubsystem->StartAttackCooldown(comboSlot, attackRecoveryCooldown);
+	}
+}
+
+void UComboComponent::OnComboResetDeadlineExpired()
+{
+	// Nothing to reset if no combo is in progress
+	if (comboCursor.IsAtRoot())
+	{
+		return;
+	}
+
+#if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
+	// Debugging messages
+	if (GEngine && ComboMetrics::ShowDebugMessages())
+	{
+		GEngine->AddOnScreenDebugMessage(0, 1.5f, FColor::Yellow, TEXT("Combo timed out"));
+	}
+#endif
+
+	RecordComboEvent(EComboTraceEventType::ComboTimedOut, comboCursor.nodeIndex, GetComboDepth());
+
+	ResetComboSequence(false);
+}
+
+FComboRollbackConfig UComboComponent::GetRollbackConfig() const
+{
+	FComboRollbackConfig config;
+
+	// At least one frame, so that a combo always gets the chance to continue on the next frame
+	config.comboResetFrames = FMath::Max<uint16>(1, ComboRollback::SecondsToFrames(timeBeforeComboReset, fixedStepFrameRate));
+	config.attackCooldownFrames = ComboRollback::SecondsToFrames(attackRecoveryCooldown, fixedStepFrameRate);
+	config.missPolicy = GetMissPolicy();
+	return config;
+}
+
+void UComboComponent::SimulateFrame(int32 attackInput)
+{
+	if (fixedStepSimulation == false || (moveSetGraph.IsValid() == false && AcquireMoveSetGraph() == false))
+	{
+		return;
+	}
+
+	{
+		COMBO_PHASE_SCOPE(AttackLookup);
+		if (moveSetLibrary.IsValid())
+		{
+			ComboRollback::SimulateFrame(*moveSetLibrary, GetRollbackConfig(), rollbackState, attackInput);
+		}
+		else
+		{
+			ComboRollback::SimulateFrame(*moveSetGraph, GetRollbackConfig(), rollbackState, attackInput);
+		}
+	}
+
+	ApplySimulatedFrame(attackInput);
+}
+
+void UComboComponent::ApplySimulatedFrame(int32 attackInput)
+{
+	// Only reads the simulated state, so that the simulation gives the same result whether or not its frames are presented.
+	// The graph is still the one of the frame's first moveset, which the event node of a frame that switches moveset belongs to.
+	const FComboGraphNode* eventNode = rollbackState.eventNodeIndex != 0 ? moveSetGraph->GetNode(rollbackState.eventNodeIndex) : nullptr;
+	const int32 eventDepth = eventNode != nullptr ? eventNode->depth : 0;
+	const bool comboEnded = rollbackState.HasFrameFlag(EComboRollbackFrameFlags::ComboBroken | EComboRollbackFrameFlags::ComboTimedOut | EComboRollbackFrameFlags::ComboCompleted);
+
+	if (attackInput != ComboRollback::NoInput && ComboRollback::IsSwitchMoveSetInput(attackInput) == false)
+	{
+		const bool inputIgnored = rollbackState.HasFrameFlag(EComboRollbackFrameFlags::InputIgnored);
+		RecordComboEvent(inputIgnored ? EComboTraceEventType::InputIgnored : EComboTraceEventType::InputReceived, comboCursor.nodeIndex, 0, static_cast<uint8>(attackInput));
+
+		if (inputIgnored == false)
+		{
+			const bool hit = rollbackState.HasFrameFlag(EComboRollbackFrameFlags::AttackPerformed);
+			ComboMetrics::RecordAttackLookup(hit, hit ? rollbackState.eventNodeIndex : INDEX_NONE, hit ? eventDepth : 0);
+		}
+	}
+
+	if (rollbackState.HasFrameFlag(EComboRollbackFrameFlags::ComboTimedOut))
+	{
+		RecordComboEvent(EComboTraceEventType::ComboTimedOut, rollbackState.eventNodeIndex, eventDepth);
+	}
+
+	if (rollbackState.HasFrameFlag(EComboRollbackFrameFlags::ComboBroken))
+	{
+		RecordComboEvent(EComboTraceEventType::Miss, rollbackState.eventNodeIndex, eventDepth);
+	}
+
+	if (rollbackState.HasFrameFlag(EComboRollbackFrameFlags::AttackPerformed) && eventNode != nullptr)
+	{
+		RecordComboEvent(EComboTraceEventType::NodeAdvanced, rollbackState.eventNodeIndex, eventDepth);
+		PlayAttackAnimation(eventNode);
+	}
+
+	comboCursor.nodeIndex = rollbackState.nodeIndex;
+	if (rollbackState.HasFrameFlag(EComboRollbackFrameFlags::MoveSetSwitched))
+	{
+		SetActiveMoveSet(rollbackState.moveSetIndex);
+
+		const FComboGraphNode* mappedNode = moveSetGraph->GetNode(comboCursor.nodeIndex);
+		RecordComboEvent(EComboTraceEventType::MoveSetSwitched, comboCursor.nodeIndex, mappedNode != nullptr ? mappedNode->depth : 0, rollbackState.moveSetIndex);
+	}
+	else
+	{
+		UpdateMontagePrefetch();
+	}
+
+	if (comboEnded)
+	{
+		const bool comboCompleted = rollbackState.HasFrameFlag(EComboRollbackFrameFlags::ComboCompleted);
+		if (eventNode != nullptr)
+		{
+			ComboMetrics::RecordComboEnded(comboCompleted, eventDepth);
+		}
+		RecordComboEvent(EComboTraceEventType::ComboReset, rollbackState.eventNodeIndex, eventDepth, comboCompleted ? 1 : 0);
+
+		{
+			COMBO_PHASE_SCOPE(DelegateBroadcast);
+			OnComboBrokenDelegate.Broadcast();
+		}
+	}
+}
+
+void UComboComponent::RestoreComboState(const FComboRollbackState& state)
+{
+	rollbackState = state;
+	comboCursor.nodeIndex = state.nodeIndex;
+
+	// The node belongs to the moveset of the snapshot. Montages already playing are left to the game, which knows how it wants to blend presentation after a rollback.
+	if (moveSetLibrary.IsValid() && state.moveSetIndex != activeMoveSetIndex && state.moveSetIndex < moveSetLibrary->GetNumMoveSets())
+	{
+		SetActiveMoveSet(state.moveSetIndex);
+	}
+	else
+	{
+		UpdateMontagePrefetch();
+	}
+}
+
+void UComboComponent::ResimulateFrames(const FComboRollbackState& fromState, TArrayView<const int32> frameInputs)
+{
+	if (fixedStepSimulation == false || (moveSetGraph.IsValid() == false && AcquireMoveSetGraph() == false))
+	{
+		return;
+	}
+
+	FComboRollbackState resimulatedState = fromState;
+	if (moveSetLibrary.IsValid())
+	{
+		ComboRollback::Resimulate(*moveSetLibrary, GetRollbackConfig(), resimulatedState, frameInputs);
+	}
+	else
+	{
+		ComboRollback::Resimulate(*moveSetGraph, GetRollbackConfig(), resimulatedState, frameInputs);
+	}
+	RestoreComboState(resimulatedState);
+}
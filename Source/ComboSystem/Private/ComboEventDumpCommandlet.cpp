@@ -0,0 +1,103 @@
+#include "ComboEventDumpCommandlet.h"
+#include "ComboEventRecorder.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogComboEventDump, Log, All);
+
+namespace
+{
+	// Describes the fields of an event that mean something for its type
+	FString DescribeEvent(const FComboTraceEvent& event)
+	{
+		switch (event.type)
+		{
+		case EComboTraceEventType::InputReceived:
+		case EComboTraceEventType::InputIgnored:
+			return FString::Printf(TEXT("input %d at node %d"), event.payload, event.nodeIndex);
+		case EComboTraceEventType::NodeAdvanced:
+		case EComboTraceEventType::MontageStarted:
+		case EComboTraceEventType::AttackQueued:
+			return FString::Printf(TEXT("node %d, depth %d"), event.nodeIndex, event.depth);
+		case EComboTraceEventType::Miss:
+		case EComboTraceEventType::ComboTimedOut:
+			return FString::Printf(TEXT("from node %d, depth %d"), event.nodeIndex, event.depth);
+		case EComboTraceEventType::ComboReset:
+			return FString::Printf(TEXT("%s at depth %d"), event.payload != 0 ? TEXT("completed") : TEXT("broken"), event.depth);
+		case EComboTraceEventType::MontageEnded:
+			return event.payload != 0 ? TEXT("interrupted") : TEXT("finished");
+		case EComboTraceEventType::ComboResumed:
+			return FString::Printf(TEXT("from depth %d at node %d, depth %d"), event.payload, event.nodeIndex, event.depth);
+		case EComboTraceEventType::MoveSetSwitched:
+			return FString::Printf(TEXT("to moveset %d at node %d, depth %d"), event.payload, event.nodeIndex, event.depth);
+		case EComboTraceEventType::PredictionCorrected:
+			return FString::Printf(TEXT("to node %d, depth %d, after input %d"), event.nodeIndex, event.depth, event.payload);
+		case EComboTraceEventType::ComboWindowOpened:
+		case EComboTraceEventType::ComboWindowClosed:
+			return FString::Printf(TEXT("%s window at node %d"), event.payload == 0 ? TEXT("accept input") : TEXT("cancel"), event.nodeIndex);
+		default:
+			return FString();
+		}
+	}
+}
+
+
+UComboEventDumpCommandlet::UComboEventDumpCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UComboEventDumpCommandlet::Main(const FString& Params)
+{
+	FString fileName;
+	if (!FParse::Value(*Params, TEXT("file="), fileName))
+	{
+		UE_LOG(LogComboEventDump, Error, TEXT("Usage: -run=ComboEventDump -file=<event file> [-actor=<name>]"));
+		return 1;
+	}
+
+	FString actorFilter;
+	FParse::Value(*Params, TEXT("actor="), actorFilter);
+
+	TArray<FComboTraceEvent> events;
+	TMap<uint32, FString> componentNames;
+	if (!ComboEventRecorder::ReadFromFile(fileName, events, componentNames))
+	{
+		UE_LOG(LogComboEventDump, Error, TEXT("%s: not a combo event file, or written by a different version"), *fileName);
+		return 1;
+	}
+
+	// Split the events into one timeline per component. The events are already in the order they were recorded.
+	TMap<uint32, TArray<const FComboTraceEvent*>> timelines;
+	for (const FComboTraceEvent& event : events)
+	{
+		timelines.FindOrAdd(event.componentId).Add(&event);
+	}
+
+	UE_LOG(LogComboEventDump, Display, TEXT("%s: %d events, %d actors"), *fileName, events.Num(), timelines.Num());
+
+	for (const TPair<uint32, TArray<const FComboTraceEvent*>>& timeline : timelines)
+	{
+		const FString* actorName = componentNames.Find(timeline.Key);
+		const FString displayName = actorName != nullptr && !actorName->IsEmpty() ? *actorName : TEXT("<unknown actor>");
+
+		if (!actorFilter.IsEmpty() && !displayName.Contains(actorFilter))
+		{
+			continue;
+		}
+
+		UE_LOG(LogComboEventDump, Display, TEXT(""));
+		UE_LOG(LogComboEventDump, Display, TEXT("%s (component %u), %d events"), *displayName, timeline.Key, timeline.Value.Num());
+
+		double previousTime = timeline.Value[0]->time;
+		for (const FComboTraceEvent* event : timeline.Value)
+		{
+			UE_LOG(LogComboEventDump, Display, TEXT("  %10.4f  +%7.4f  %-16s %s"), event->time, event->time - previousTime,
+				ComboEventRecorder::GetEventTypeName(event->type), *DescribeEvent(*event));
+			previousTime = event->time;
+		}
+	}
+
+	return 0;
+}
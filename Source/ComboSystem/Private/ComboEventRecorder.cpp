@@ -0,0 +1,156 @@
+#include "ComboEventRecorder.h"
+#include "HAL/FileManager.h"
+
+namespace
+{
+	// Reads or writes one event field by field, so that the file layout does not depend on struct padding
+	void SerializeEvent(FArchive& archive, FComboTraceEvent& event)
+	{
+		uint8 type = static_cast<uint8>(event.type);
+
+		archive << event.time;
+		archive << event.componentId;
+		archive << event.nodeIndex;
+		archive << event.depth;
+		archive << type;
+		archive << event.payload;
+
+		event.type = static_cast<EComboTraceEventType>(type);
+	}
+}
+
+
+void ComboEventRecorder::RegisterComponentName(uint32 componentId, FName actorName)
+{
+	componentNames.Add(componentId, actorName);
+
+	// Forget the components that have no events left in the buffer, so that spawn churn does not grow the name table forever
+	if (componentNames.Num() > Capacity)
+	{
+		TSet<uint32> recordedComponentIds;
+		const int32 storedEventCount = static_cast<int32>(FMath::Min<uint64>(recordedEventCount, Capacity));
+		for (int32 eventIndex = 0; eventIndex < storedEventCount; eventIndex++)
+		{
+			recordedComponentIds.Add(events[eventIndex].componentId);
+		}
+
+		for (auto componentNameIt = componentNames.CreateIterator(); componentNameIt; ++componentNameIt)
+		{
+			if (componentNameIt->Key != componentId && !recordedComponentIds.Contains(componentNameIt->Key))
+			{
+				componentNameIt.RemoveCurrent();
+			}
+		}
+	}
+}
+
+void ComboEventRecorder::CopyEvents(TArray<FComboTraceEvent>& outEvents) const
+{
+	const int32 storedEventCount = static_cast<int32>(FMath::Min<uint64>(recordedEventCount, Capacity));
+
+	// Once the buffer has wrapped, the oldest event is the one that will be overwritten next
+	const int32 oldestEventIndex = recordedEventCount > Capacity ? static_cast<int32>(recordedEventCount % Capacity) : 0;
+
+	outEvents.Reset(storedEventCount);
+	for (int32 eventOffset = 0; eventOffset < storedEventCount; eventOffset++)
+	{
+		outEvents.Add(events[(oldestEventIndex + eventOffset) % Capacity]);
+	}
+}
+
+bool ComboEventRecorder::WriteToFile(const FString& fileName) const
+{
+	TArray<FComboTraceEvent> storedEvents;
+	CopyEvents(storedEvents);
+
+	// Only the names of components that appear in the events are written
+	TMap<uint32, FString> storedComponentNames;
+	for (const FComboTraceEvent& event : storedEvents)
+	{
+		if (!storedComponentNames.Contains(event.componentId))
+		{
+			const FName* actorName = componentNames.Find(event.componentId);
+			storedComponentNames.Add(event.componentId, actorName != nullptr ? actorName->ToString() : FString());
+		}
+	}
+
+	TUniquePtr<FArchive> writer(IFileManager::Get().CreateFileWriter(*fileName));
+	if (!writer.IsValid())
+	{
+		return false;
+	}
+
+	uint32 magic = FileMagic;
+	uint32 version = FileVersion;
+	int32 eventCount = storedEvents.Num();
+	*writer << magic;
+	*writer << version;
+	*writer << eventCount;
+
+	for (FComboTraceEvent& event : storedEvents)
+	{
+		SerializeEvent(*writer, event);
+	}
+
+	*writer << storedComponentNames;
+
+	return writer->Close();
+}
+
+bool ComboEventRecorder::ReadFromFile(const FString& fileName, TArray<FComboTraceEvent>& outEvents, TMap<uint32, FString>& outComponentNames)
+{
+	outEvents.Reset();
+	outComponentNames.Reset();
+
+	TUniquePtr<FArchive> reader(IFileManager::Get().CreateFileReader(*fileName));
+	if (!reader.IsValid())
+	{
+		return false;
+	}
+
+	uint32 magic = 0;
+	uint32 version = 0;
+	int32 eventCount = 0;
+	*reader << magic;
+	*reader << version;
+	*reader << eventCount;
+
+	if (reader->IsError() || magic != FileMagic || version != FileVersion || eventCount < 0 || eventCount > Capacity)
+	{
+		return false;
+	}
+
+	outEvents.SetNum(eventCount);
+	for (FComboTraceEvent& event : outEvents)
+	{
+		SerializeEvent(*reader, event);
+	}
+
+	*reader << outComponentNames;
+
+	return !reader->IsError();
+}
+
+const TCHAR* ComboEventRecorder::GetEventTypeName(EComboTraceEventType type)
+{
+	switch (type)
+	{
+	case EComboTraceEventType::InputReceived: return TEXT("InputReceived");
+	case EComboTraceEventType::InputIgnored: return TEXT("InputIgnored");
+	case EComboTraceEventType::NodeAdvanced: return TEXT("NodeAdvanced");
+	case EComboTraceEventType::Miss: return TEXT("Miss");
+	case EComboTraceEventType::ComboTimedOut: return TEXT("ComboTimedOut");
+	case EComboTraceEventType::ComboReset: return TEXT("ComboReset");
+	case EComboTraceEventType::CooldownStarted: return TEXT("CooldownStarted");
+	case EComboTraceEventType::CooldownEnded: return TEXT("CooldownEnded");
+	case EComboTraceEventType::MontageStarted: return TEXT("MontageStarted");
+	case EComboTraceEventType::MontageEnded: return TEXT("MontageEnded");
+	case EComboTraceEventType::ComboWindowOpened: return TEXT("ComboWindowOpened");
+	case EComboTraceEventType::ComboWindowClosed: return TEXT("ComboWindowClosed");
+	case EComboTraceEventType::AttackQueued: return TEXT("AttackQueued");
+	case EComboTraceEventType::PredictionCorrected: return TEXT("PredictionCorrected");
+	case EComboTraceEventType::ComboResumed: return TEXT("ComboResumed");
+	case EComboTraceEventType::MoveSetSwitched: return TEXT("MoveSetSwitched");
+	default: return TEXT("Unknown");
+	}
+}
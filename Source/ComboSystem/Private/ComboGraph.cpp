@@ -1,260 +1,784 @@
 #include "ComboGraph.h"
+#include "ComboGraphCompiler.h"
+#include "ComboMetrics.h"
+#include "ComboStaticMoveset.h"
+#include "Misc/MemStack.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+#include <arm_neon.h>
+#elif PLATFORM_ENABLE_VECTORINTRINSICS
+#include <emmintrin.h>
+#endif
+
+LLM_DEFINE_TAG(ComboGraph);
+
+// Footprint of the combo graphs that are alive
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Combo Graphs"), STAT_ComboGraphCount, STATGROUP_COMBOGRAPH);
+DECLARE_MEMORY_STAT(TEXT("Combo Graph Memory"), STAT_ComboGraphMemory, STATGROUP_COMBOGRAPH);
 
 #if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
-//Stat groups for performance checking for combo search
-DECLARE_STATS_GROUP(TEXT("ComboGraph_Component"), STATGROUP_COMBOGRAPH, STATCAT_Advanced);
 DECLARE_CYCLE_STAT(TEXT("FastSearchForAttack"), STAT_FastSearchForAttack, STATGROUP_COMBOGRAPH);
 #endif
 
 
-void ComboGraph::CreateComboGraph(UDataTable* movesetTable)
+ComboGraph::~ComboGraph()
 {
-#if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
-	// Debugging messages
-	if (GEngine)
+	ReleaseGraphMemory();
+}
+
+void ComboGraph::ReleaseGraphMemory()
+{
+	if (imageHeader != nullptr)
 	{
-		GEngine->AddOnScreenDebugMessage(0, 1.5f, FColor::Yellow, TEXT("Beginning combo graph creation"));
+		DEC_DWORD_STAT(STAT_ComboGraphCount);
+		DEC_MEMORY_STAT_BY(STAT_ComboGraphMemory, trackedAllocatedSize);
 	}
-#endif
+	trackedAllocatedSize = 0;
 
-	rootNode = *(new FComboGraphNode());
+	if (ownedImage != nullptr)
+	{
+		FMemory::Free(ownedImage);
+	}
 
-	TArray<FName> rowNames = movesetTable->GetRowNames(); 
-	int rowCount = rowNames.Num();
+	ownedImage = nullptr;
+	imageOwner.Reset();
+	imageHeader = nullptr;
+	nodes = nullptr;
+	indexSlots = nullptr;
+	failureLinks = nullptr;
+	nodeRanges = nullptr;
+	finishers = nullptr;
+	transitionInputs = nullptr;
+	denseTransitions = nullptr;
+	denseInputSymbols = nullptr;
+	denseSymbolCount = 0;
+	nodeCount = 0;
+	indexSlotMask = 0;
+	packedBitsPerInput = 0;
+	maxPackedAttackChainLength = 0;
+	treeDepth = -1;
+
+	ownedMoveData.Empty();
+	moveData = nullptr;
+	sharedMoveData.Reset();
+	sharedMoveIndices.Empty();
+}
 
+void ComboGraph::AttachImage(const uint8* image, const FComboGraphMoveData* imageMoveData)
+{
+	const FComboGraphImageHeader* header = reinterpret_cast<const FComboGraphImageHeader*>(image);
+
+	imageHeader = header;
+	nodes = reinterpret_cast<const FComboGraphNode*>(image + header->nodesOffset);
+	indexSlots = reinterpret_cast<const FComboGraphIndexSlot*>(image + header->indexSlotsOffset);
+	failureLinks = reinterpret_cast<const int32*>(image + header->failureLinksOffset);
+	nodeRanges = reinterpret_cast<const FComboGraphNodeRange*>(image + header->nodeRangesOffset);
+	finishers = reinterpret_cast<const int32*>(image + header->finishersOffset);
+	transitionInputs = image + header->transitionInputsOffset;
+	nodeCount = header->nodeCount;
+	indexSlotMask = header->indexSlotCount - 1;
+	packedBitsPerInput = header->packedBitsPerInput;
+	maxPackedAttackChainLength = GetMaxPackedAttackChainLength(packedBitsPerInput);
+	treeDepth = header->treeDepth;
+	moveData = imageMoveData;
+
+	trackedAllocatedSize = GetAllocatedSize();
+	INC_DWORD_STAT(STAT_ComboGraphCount);
+	INC_MEMORY_STAT_BY(STAT_ComboGraphMemory, trackedAllocatedSize);
+}
 
-	int maxTreeDepth = -1;
-	// Find the max tree depth
-	// We do this by checking what is the longest input sequence to activate a move
-	// The number of inputs required to achieve a combo is the same as the tree depth at which the node would reside, so we simply find the longest number of inputs required to activate any of the moves
-	for (int rowIndex = 0; rowIndex < rowCount; rowIndex++)
+bool ComboGraph::PackAttackChain(const TArray<TEnumAsByte<AttackType_Enum>>& attackChain, uint64& outPackedChain) const
+{
+	if (attackChain.Num() > maxPackedAttackChainLength)
 	{
-		FAttackAction_Struct* attackToCheck = movesetTable->FindRow<FAttackAction_Struct>(rowNames[rowIndex], "");
-
-		int inputsRequiredForAttack = attackToCheck->requiredSequenceToActivateAttack.Num();
+		return false;
+	}
 
-		if (inputsRequiredForAttack > maxTreeDepth)
+	uint64 packedChain = EmptyPackedAttackChain;
+	for (const TEnumAsByte<AttackType_Enum>& input : attackChain)
+	{
+		const uint8 inputValue = input.GetValue();
+		if ((inputValue >> packedBitsPerInput) != 0)
 		{
-			maxTreeDepth = inputsRequiredForAttack;
+			return false;
 		}
+
+		packedChain = AppendToPackedAttackChain(packedChain, inputValue, packedBitsPerInput);
 	}
-	// Make sure there is at least one attack chain in the moveset
-	if (maxTreeDepth <= 0)
-	{
-		// TODO: Throw an exception here because the provided data table is invalid
-	}
 
-	treeDepth = maxTreeDepth;
+	outPackedChain = packedChain;
+	return true;
+}
+
+bool ComboGraph::CreateComboGraph(UDataTable* movesetTable)
+{
+	TArray<FComboGraphDiagnostic> diagnostics;
+	return CreateComboGraph(movesetTable, diagnostics);
+}
 
+bool ComboGraph::CreateComboGraph(UDataTable* movesetTable, TArray<FComboGraphDiagnostic>& outDiagnostics)
+{
 #if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
 	// Debugging messages
 	if (GEngine)
 	{
-		GEngine->AddOnScreenDebugMessage(1, 1.5f, FColor::Yellow, TEXT("Max Tree Depth: " + FString::FromInt(maxTreeDepth)));
+		GEngine->AddOnScreenDebugMessage(0, 1.5f, FColor::Yellow, TEXT("Beginning combo graph creation"));
 	}
 #endif
 
+	const bool graphCreated = ComboGraphCompiler::Compile(movesetTable, *this, outDiagnostics);
 
-	// Next, fill out the graph one depth level at a time
-	for (int currentTreeDepthLevel = 1; currentTreeDepthLevel <= maxTreeDepth; currentTreeDepthLevel++)
+#if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
+	// Debugging messages
+	if (GEngine)
 	{
-		for (int rowIndex = 0; rowIndex < rowCount; rowIndex++)
+		for (const FComboGraphDiagnostic& diagnostic : outDiagnostics)
 		{
-			FAttackAction_Struct* attackToCheck = movesetTable->FindRow<FAttackAction_Struct>(rowNames[rowIndex], "");
+			GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Moveset problem in row ") + diagnostic.rowName.ToString() + TEXT(": ") + diagnostic.message);
+		}
 
-			int attackChainLength = attackToCheck->requiredSequenceToActivateAttack.Num();
+		if (graphCreated)
+		{
+			GEngine->AddOnScreenDebugMessage(3, 1.5f, FColor::Yellow, TEXT("Moveset graph succesfully built"));
+		}
+	}
+#endif
 
-			// Skip this move if it does not fit at the current tree depth level
-			if (attackChainLength != currentTreeDepthLevel)
-			{
-				continue;
-			}
+	return graphCreated;
+}
 
-			// If the chain length is 1, then the move is a basic move that only requires one input to execute, in which case insert it right away under the "empty" root node
-			if (attackChainLength == 1)
-			{
-				FComboGraphNode* newAttackToInsert = new FComboGraphNode();
-				newAttackToInsert->attackData = attackToCheck;
-				newAttackToInsert->parentNode = &rootNode;
+void ComboGraph::InitializeFromCompiledNodes(TArrayView<const FComboGraphNode> compiledNodes, TArrayView<const uint8> compiledInputs, TArray<FComboGraphMoveData>&& compiledMoveData)
+{
+	check(compiledNodes.Num() > 0 && compiledNodes.Num() == compiledInputs.Num() && compiledNodes.Num() == compiledMoveData.Num());
+
+	LLM_SCOPE_BYTAG(ComboGraph);
+
+	ReleaseGraphMemory();
+
+	// Scratch memory only needed while the image is built comes from the thread's memory stack and is freed all at once
+	FMemMark scratchMark(FMemStack::Get());
+
+	const int32 compiledNodeCount = compiledNodes.Num();
+
+	// Use as few bits per input as the largest input of the moveset allows, so that packed keys hold chains as long as possible
+	uint8 largestInput = 0;
+	for (int32 nodeIndex = 1; nodeIndex < compiledNodeCount; nodeIndex++)
+	{
+		largestInput = FMath::Max(largestInput, compiledInputs[nodeIndex]);
+	}
+	const int32 bitsPerInput = FMath::Max(1, int32(FMath::CeilLogTwo(uint32(largestInput) + 1)));
+	const int32 maxChainLength = GetMaxPackedAttackChainLength(bitsPerInput);
 
-				rootNode.childrenNodes.Add(newAttackToInsert);
+	int32 compiledFinisherCount = 0;
+	for (const FComboGraphNode& compiledNode : compiledNodes)
+	{
+		compiledFinisherCount += compiledNode.childCount == 0 ? 1 : 0;
+	}
+
+	// Keep the index at most half full so that probe sequences stay short
+	const int32 slotCount = FMath::RoundUpToPowerOfTwo(FMath::Max(compiledNodeCount * 2, 2));
+
+	// Lay out the whole image and allocate it in one go
+	FComboGraphImageHeader header;
+	header.magic = ImageMagic;
+	header.version = ImageVersion;
+	header.nodeCount = compiledNodeCount;
+	header.indexSlotCount = slotCount;
+	header.packedBitsPerInput = bitsPerInput;
+	header.finisherCount = compiledFinisherCount;
+	header.nodesOffset = sizeof(FComboGraphImageHeader);
+	header.indexSlotsOffset = Align(header.nodesOffset + sizeof(FComboGraphNode) * compiledNodeCount, alignof(FComboGraphIndexSlot));
+	header.failureLinksOffset = header.indexSlotsOffset + sizeof(FComboGraphIndexSlot) * slotCount;
+	header.nodeRangesOffset = header.failureLinksOffset + sizeof(int32) * compiledNodeCount;
+	header.finishersOffset = header.nodeRangesOffset + sizeof(FComboGraphNodeRange) * (compiledNodeCount + 1);
+	header.transitionInputsOffset = header.finishersOffset + sizeof(int32) * compiledFinisherCount;
+	header.imageSize = Align(header.transitionInputsOffset + compiledNodeCount + TransitionInputPadding, alignof(FComboGraphImageHeader));
+
+	// Nodes are in breadth-first order, so the last node is one of the deepest
+	header.treeDepth = compiledNodes.Last().depth;
+
+	ownedImage = FMemory::MallocZeroed(header.imageSize, PLATFORM_CACHE_LINE_SIZE);
+	uint8* image = static_cast<uint8*>(ownedImage);
+
+	FMemory::Memcpy(image, &header, sizeof(FComboGraphImageHeader));
+	FMemory::Memcpy(image + header.nodesOffset, compiledNodes.GetData(), sizeof(FComboGraphNode) * compiledNodeCount);
+	FMemory::Memcpy(image + header.transitionInputsOffset, compiledInputs.GetData(), compiledNodeCount);
+
+	// Fill the packed attack chain index. Empty slots are already zeroed.
+	// Parents always come before their children, so every parent key is known by the time its children are reached.
+	FComboGraphIndexSlot* writableIndexSlots = reinterpret_cast<FComboGraphIndexSlot*>(image + header.indexSlotsOffset);
+
+	// Packed key of the attack chain leading to each node, 0 once the chain no longer fits in a key
+	TArray<uint64, TMemStackAllocator<>> packedNodeChains;
+	packedNodeChains.SetNumZeroed(compiledNodeCount);
+	packedNodeChains[0] = EmptyPackedAttackChain;
+
+	for (int32 nodeIndex = 1; nodeIndex < compiledNodeCount; nodeIndex++)
+	{
+		const uint64 parentPackedChain = packedNodeChains[compiledNodes[nodeIndex].parentIndex];
+		const uint8 nodeInput = compiledInputs[nodeIndex];
 
-				// We can safely skip the rest of the loop for this iteration
-				continue;
+		// Index the node by its packed attack chain as long as the chain still fits in a key
+		if (parentPackedChain != 0 && compiledNodes[nodeIndex].depth <= maxChainLength)
+		{
+			const uint64 nodePackedChain = AppendToPackedAttackChain(parentPackedChain, nodeInput, bitsPerInput);
+			packedNodeChains[nodeIndex] = nodePackedChain;
+
+			int32 slot = GetFirstIndexSlot(nodePackedChain, slotCount - 1);
+			while (writableIndexSlots[slot].packedChain != 0)
+			{
+				slot = (slot + 1) & (slotCount - 1);
 			}
 
-			// Get the attack chain required to reach the parent of the current attack by removing the final input
-			TArray<TEnumAsByte<AttackType_Enum>> parentMoveChain = attackToCheck->requiredSequenceToActivateAttack;
-			parentMoveChain.RemoveAt(parentMoveChain.Num() - 1);
+			writableIndexSlots[slot].packedChain = nodePackedChain;
+			writableIndexSlots[slot].nodeIndex = nodeIndex;
+		}
+	}
 
-			FComboGraphNode* currentAttackParentNode = FindNodeWithAttackChain(parentMoveChain);
+	// Fill the failure links. Links always point to shallower nodes, which come earlier in breadth-first order, so every link a node needs is known by the time it is reached.
+	int32* writableFailureLinks = reinterpret_cast<int32*>(image + header.failureLinksOffset);
+	writableFailureLinks[0] = 0;
 
-			// If the pointer is null, throw an exception because there is an unreachable attack in the moveset
-			if (currentAttackParentNode == nullptr)
+	const auto findCompiledChild = [&compiledNodes, &compiledInputs](int32 nodeIndex, uint8 input)
+	{
+		const FComboGraphNode& node = compiledNodes[nodeIndex];
+		for (int32 childIndex = node.firstChildIndex; childIndex < node.firstChildIndex + node.childCount; childIndex++)
+		{
+			if (compiledInputs[childIndex] == input)
 			{
-				// TODO: Throw exception here for invalid attack chain in the moveset
+				return childIndex;
 			}
+		}
+		return int32(INDEX_NONE);
+	};
 
-			FComboGraphNode* newAttackToInsert = new FComboGraphNode();
-			newAttackToInsert->attackData = attackToCheck;
-			newAttackToInsert->parentNode = currentAttackParentNode;
-			currentAttackParentNode->childrenNodes.Add(newAttackToInsert);
+	for (int32 nodeIndex = 1; nodeIndex < compiledNodeCount; nodeIndex++)
+	{
+		const int32 parentIndex = compiledNodes[nodeIndex].parentIndex;
+		const uint8 nodeInput = compiledInputs[nodeIndex];
 
-#if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
-			// Debugging messages
-			if (GEngine)
+		// The longest suffix of the node's chain is the longest suffix of its parent's chain that continues with the node's input
+		int32 failureLink = 0;
+		if (parentIndex != 0)
+		{
+			for (int32 suffixIndex = writableFailureLinks[parentIndex]; ; suffixIndex = writableFailureLinks[suffixIndex])
 			{
-				GEngine->AddOnScreenDebugMessage(2, 1.5f, FColor::Yellow, TEXT("Inserted attack into moveset graph: " + attackToCheck->moveName));
+				const int32 suffixChildIndex = findCompiledChild(suffixIndex, nodeInput);
+				if (suffixChildIndex != INDEX_NONE)
+				{
+					failureLink = suffixChildIndex;
+					break;
+				}
+				if (suffixIndex == 0)
+				{
+					break;
+				}
 			}
-#endif
 		}
+
+		// A suffix without children cannot match any input, so skip straight to its own link
+		if (failureLink != 0 && compiledNodes[failureLink].childCount == 0)
+		{
+			failureLink = writableFailureLinks[failureLink];
+		}
+		writableFailureLinks[nodeIndex] = failureLink;
 	}
 
+	// Fill the node ranges and finishers.
+	// Children are laid out in the order of their parents, so the children of every node start where those of the node before it end.
+	FComboGraphNodeRange* writableNodeRanges = reinterpret_cast<FComboGraphNodeRange*>(image + header.nodeRangesOffset);
+	int32* writableFinishers = reinterpret_cast<int32*>(image + header.finishersOffset);
 
-#if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
-	// Debugging messages
-	if (GEngine)
+	int32 childRangeStart = 1;
+	int32 finisherRank = 0;
+	for (int32 nodeIndex = 0; nodeIndex < compiledNodeCount; nodeIndex++)
 	{
-		GEngine->AddOnScreenDebugMessage(3, 1.5f, FColor::Yellow, TEXT("Moveset graph succesfully built"));
+		const FComboGraphNode& compiledNode = compiledNodes[nodeIndex];
+		checkSlow(compiledNode.childCount == 0 || compiledNode.firstChildIndex == childRangeStart);
+
+		writableNodeRanges[nodeIndex].childRangeStart = childRangeStart;
+		writableNodeRanges[nodeIndex].finisherRank = finisherRank;
+		childRangeStart += compiledNode.childCount;
+
+		if (compiledNode.childCount == 0)
+		{
+			writableFinishers[finisherRank++] = nodeIndex;
+		}
 	}
-#endif
+	writableNodeRanges[compiledNodeCount].childRangeStart = childRangeStart;
+	writableNodeRanges[compiledNodeCount].finisherRank = finisherRank;
+
+	// Size of every subtree, children first. Children always come after their parents, so walking backwards sees every child before its parent.
+	TArray<int32, TMemStackAllocator<>> subtreeSizes;
+	subtreeSizes.Init(1, compiledNodeCount);
+	for (int32 nodeIndex = compiledNodeCount - 1; nodeIndex > 0; nodeIndex--)
+	{
+		subtreeSizes[compiledNodes[nodeIndex].parentIndex] += subtreeSizes[nodeIndex];
+	}
+
+	// Depth-first positions, parents first. Each child starts right after the subtrees of its earlier siblings.
+	writableNodeRanges[0].preorderIndex = 0;
+	for (int32 nodeIndex = 0; nodeIndex < compiledNodeCount; nodeIndex++)
+	{
+		const FComboGraphNode& compiledNode = compiledNodes[nodeIndex];
+		int32 childPreorderIndex = writableNodeRanges[nodeIndex].preorderIndex + 1;
+		for (int32 childIndex = compiledNode.firstChildIndex; childIndex < compiledNode.firstChildIndex + compiledNode.childCount; childIndex++)
+		{
+			writableNodeRanges[childIndex].preorderIndex = childPreorderIndex;
+			childPreorderIndex += subtreeSizes[childIndex];
+		}
+		writableNodeRanges[nodeIndex].subtreeEnd = writableNodeRanges[nodeIndex].preorderIndex + subtreeSizes[nodeIndex];
+	}
+	writableNodeRanges[compiledNodeCount].preorderIndex = compiledNodeCount;
+	writableNodeRanges[compiledNodeCount].subtreeEnd = compiledNodeCount;
+
+	ownedMoveData = MoveTemp(compiledMoveData);
+	AttachImage(image, ownedMoveData.GetData());
+}
+
+bool ComboGraph::IsValidImage(const uint8* image, int32 imageSize, int32 moveDataCount)
+{
+	// Only the header is checked. Images are written by the graph itself at cook time, so the sections are trusted once the header matches.
+	if (image == nullptr || imageSize < int32(sizeof(FComboGraphImageHeader)) || !IsAligned(image, alignof(FComboGraphIndexSlot)))
+	{
+		return false;
+	}
+
+	const FComboGraphImageHeader* header = reinterpret_cast<const FComboGraphImageHeader*>(image);
+
+	return header->magic == ImageMagic
+		&& header->version == ImageVersion
+		&& header->imageSize == uint32(imageSize)
+		&& header->nodeCount > 0
+		&& header->nodeCount == moveDataCount
+		&& FMath::IsPowerOfTwo(header->indexSlotCount)
+		&& header->packedBitsPerInput >= 1 && header->packedBitsPerInput <= 8
+		&& header->nodesOffset + uint64(sizeof(FComboGraphNode)) * header->nodeCount <= header->indexSlotsOffset
+		&& header->indexSlotsOffset + uint64(sizeof(FComboGraphIndexSlot)) * header->indexSlotCount <= header->failureLinksOffset
+		&& IsAligned(header->failureLinksOffset, alignof(int32))
+		&& header->failureLinksOffset + uint64(sizeof(int32)) * header->nodeCount <= header->nodeRangesOffset
+		&& IsAligned(header->nodeRangesOffset, alignof(FComboGraphNodeRange))
+		&& header->nodeRangesOffset + uint64(sizeof(FComboGraphNodeRange)) * (uint64(header->nodeCount) + 1) <= header->finishersOffset
+		&& header->finisherCount > 0 && header->finisherCount <= header->nodeCount
+		&& header->finishersOffset + uint64(sizeof(int32)) * header->finisherCount <= header->transitionInputsOffset
+		&& header->transitionInputsOffset + uint64(header->nodeCount) + TransitionInputPadding <= header->imageSize;
 }
 
-FComboGraphNode* ComboGraph::FindNodeWithAttackChain(TArray<TEnumAsByte<AttackType_Enum>> attackChainToFind)
+bool ComboGraph::InitializeFromImage(const uint8* image, int32 imageSize, const FComboGraphMoveData* imageMoveData, int32 imageMoveDataCount)
 {
-	TQueue<FComboGraphNode*>* nodesToSearch = new TQueue<FComboGraphNode*>();
-	
-	// Add children of root nodes to the queue because we don't want to search the root node which has an empty attack chain
-	for (int childIndex = 0; childIndex < rootNode.childrenNodes.Num(); childIndex++)
+	ReleaseGraphMemory();
+
+	if (!IsValidImage(image, imageSize, imageMoveDataCount))
 	{
-		nodesToSearch->Enqueue(rootNode.childrenNodes[childIndex]);
+		return false;
 	}
 
-	FComboGraphNode* currentNode;
+	AttachImage(image, imageMoveData);
+	return true;
+}
 
-	nodesToSearch->Dequeue(currentNode);
+bool ComboGraph::InitializeFromStaticMoveset(const FComboStaticMovesetTable& staticMoveset)
+{
+	ReleaseGraphMemory();
 
-	while (currentNode != nullptr)
+	if (!IsValidImage(staticMoveset.image, staticMoveset.imageSize, staticMoveset.nodeCount) || staticMoveset.symbolCount < 1)
 	{
-		// Check if the current node is the one we are searching for
-		if (currentNode->attackData->requiredSequenceToActivateAttack == attackChainToFind)
+		return false;
+	}
+
+	// The move data is kept as plain strings in the game module, so it is the only part of the graph built at runtime
+	ownedMoveData.SetNum(staticMoveset.nodeCount);
+	for (int32 nodeIndex = 0; nodeIndex < staticMoveset.nodeCount; nodeIndex++)
+	{
+		FComboGraphMoveData& nodeMove = ownedMoveData[nodeIndex];
+		nodeMove.rowName = FName(staticMoveset.rowNames[nodeIndex]);
+		nodeMove.moveName = staticMoveset.moveNames[nodeIndex];
+		nodeMove.attackAnimation = TSoftObjectPtr<UAnimMontage>(FSoftObjectPath(staticMoveset.attackAnimationPaths[nodeIndex]));
+	}
+
+	denseTransitions = staticMoveset.transitions;
+	denseInputSymbols = staticMoveset.inputSymbols;
+	denseSymbolCount = staticMoveset.symbolCount;
+
+	AttachImage(staticMoveset.image, ownedMoveData.GetData());
+	return true;
+}
+
+void ComboGraph::CopyImage(TArray<uint8>& outImage) const
+{
+	outImage.Reset();
+
+	if (imageHeader != nullptr)
+	{
+		outImage.Append(reinterpret_cast<const uint8*>(imageHeader), imageHeader->imageSize);
+	}
+}
+
+void ComboGraph::CopyMoveData(TArray<FComboGraphMoveData>& outMoveData) const
+{
+	outMoveData.Reset(nodeCount);
+	for (int32 nodeIndex = 0; nodeIndex < nodeCount; nodeIndex++)
+	{
+		FComboGraphMoveData& nodeMove = outMoveData.Add_GetRef(GetMoveData(&nodes[nodeIndex]));
+		nodeMove.rowName = GetRowName(&nodes[nodeIndex]);
+	}
+}
+
+void ComboGraph::ShareMoveData(const TSharedRef<const TArray<FComboGraphMoveData>, ESPMode::ThreadSafe>& libraryMoveData, TArray<int32>&& nodeMoveIndices)
+{
+	check(imageHeader != nullptr && nodeMoveIndices.Num() == nodeCount);
+
+	sharedMoveData = libraryMoveData;
+	sharedMoveIndices = MoveTemp(nodeMoveIndices);
+	moveData = libraryMoveData->GetData();
+	ownedMoveData.Empty();
+
+	DEC_MEMORY_STAT_BY(STAT_ComboGraphMemory, trackedAllocatedSize);
+	trackedAllocatedSize = GetAllocatedSize();
+	INC_MEMORY_STAT_BY(STAT_ComboGraphMemory, trackedAllocatedSize);
+}
+
+void ComboGraph::ShareImage(const TSharedRef<const ComboGraph, ESPMode::ThreadSafe>& owner)
+{
+	check(imageHeader != nullptr && owner->imageHeader != nullptr && owner->GetImageSize() == GetImageSize() && denseTransitions == nullptr);
+
+	// Attaching the shared image counts the graph in the stats again
+	DEC_DWORD_STAT(STAT_ComboGraphCount);
+	DEC_MEMORY_STAT_BY(STAT_ComboGraphMemory, trackedAllocatedSize);
+
+	if (ownedImage != nullptr)
+	{
+		FMemory::Free(ownedImage);
+		ownedImage = nullptr;
+	}
+
+	imageOwner = owner;
+	AttachImage(reinterpret_cast<const uint8*>(owner->imageHeader), moveData);
+}
+
+SIZE_T ComboGraph::GetAllocatedSize() const
+{
+	SIZE_T allocatedSize = ownedImage != nullptr ? GetImageSize() : 0;
+
+	allocatedSize += ownedMoveData.GetAllocatedSize() + sharedMoveIndices.GetAllocatedSize();
+	for (const FComboGraphMoveData& ownedMove : ownedMoveData)
+	{
+		allocatedSize += ownedMove.moveName.GetAllocatedSize();
+	}
+
+	return allocatedSize;
+}
+
+namespace
+{
+	// Number of child inputs compared at once
+	constexpr int32 ChildInputChunkSize = 16;
+
+	// Returns the offset of the first of the first inputCount inputs of the chunk that matches the input, or INDEX_NONE.
+	// Always reads a whole chunk, the image padding keeps the read inside the image.
+	FORCEINLINE int32 FindInputInChunk(const uint8* chunkInputs, int32 inputCount, uint8 input)
+	{
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+		const uint8x16_t matches = vceqq_u8(vld1q_u8(chunkInputs), vdupq_n_u8(input));
+
+		// NEON has no movemask, so narrow every lane to 4 bits of a 64 bit mask instead
+		uint64 matchMask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+		if (inputCount < ChildInputChunkSize)
 		{
-			return currentNode;
+			matchMask &= (uint64(1) << (inputCount * 4)) - 1;
 		}
+		return matchMask != 0 ? int32(FMath::CountTrailingZeros64(matchMask) / 4) : INDEX_NONE;
+#elif PLATFORM_ENABLE_VECTORINTRINSICS
+		const __m128i matches = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(chunkInputs)), _mm_set1_epi8(char(input)));
 
-		// Add all children nodes to the queue for next iterations of the search
-		for (int childIndex = 0; childIndex < currentNode->childrenNodes.Num(); childIndex++)
+		uint32 matchMask = uint32(_mm_movemask_epi8(matches));
+		if (inputCount < ChildInputChunkSize)
+		{
+			matchMask &= (1u << inputCount) - 1;
+		}
+		return matchMask != 0 ? int32(FMath::CountTrailingZeros(matchMask)) : INDEX_NONE;
+#else
+		const int32 chunkInputCount = FMath::Min(inputCount, ChildInputChunkSize);
+		for (int32 inputOffset = 0; inputOffset < chunkInputCount; inputOffset++)
 		{
-			nodesToSearch->Enqueue(currentNode->childrenNodes[childIndex]);
+			if (chunkInputs[inputOffset] == input)
+			{
+				return inputOffset;
+			}
 		}
+		return INDEX_NONE;
+#endif
+	}
+}
+
+int32 ComboGraph::FindChildWithInput(int32 nodeIndex, uint8 input) const
+{
+	// Movesets compiled into the game have the answer for every input laid out already
+	if (denseTransitions != nullptr)
+	{
+		return denseTransitions[nodeIndex * denseSymbolCount + denseInputSymbols[input]];
+	}
+
+	const FComboGraphNode& node = nodes[nodeIndex];
 
-		// Either break out of the loop if the queue is empty
-		if (nodesToSearch->IsEmpty())
+	// The inputs of all children sit next to each other, so they are compared against the input 16 at a time.
+	// Nodes with up to 16 branches take a single compare whatever the size of the input alphabet.
+	const uint8* childInputs = transitionInputs + node.firstChildIndex;
+	for (int32 chunkStart = 0; chunkStart < node.childCount; chunkStart += ChildInputChunkSize)
+	{
+		const int32 chunkOffset = FindInputInChunk(childInputs + chunkStart, node.childCount - chunkStart, input);
+		if (chunkOffset != INDEX_NONE)
 		{
-			currentNode = nullptr;
+			return node.firstChildIndex + chunkStart + chunkOffset;
 		}
-		// Or proceed to search the next element
-		else
+	}
+
+	return INDEX_NONE;
+}
+
+bool ComboGraph::ProbePackedAttackChainIndex(const TArray<TEnumAsByte<AttackType_Enum>>& attackChainToFind, const FComboGraphNode*& outNode) const
+{
+	uint64 packedChain = 0;
+	if (!PackAttackChain(attackChainToFind, packedChain))
+	{
+		return false;
+	}
+
+	outNode = nullptr;
+	if (nodeCount == 0)
+	{
+		return true;
+	}
+
+	// Linear probing until the key or an empty slot is found. The empty chain leads to the root node, which is not an attack, so it is never in the index.
+	for (int32 slot = GetFirstIndexSlot(packedChain, indexSlotMask); indexSlots[slot].packedChain != 0; slot = (slot + 1) & indexSlotMask)
+	{
+		if (indexSlots[slot].packedChain == packedChain)
 		{
-			nodesToSearch->Dequeue(currentNode);
+			outNode = &nodes[indexSlots[slot].nodeIndex];
+			break;
 		}
 	}
+	return true;
+}
 
-	return nullptr;
+const FComboGraphNode* ComboGraph::FindNodeWithAttackChain(const TArray<TEnumAsByte<AttackType_Enum>>& attackChainToFind) const
+{
+	return FastFindNodeWithAttackChain(attackChainToFind);
 }
 
 
-FComboGraphNode* ComboGraph::FastFindNodeWithAttackChain(TArray<TEnumAsByte<AttackType_Enum>> attackChainToFind)
+const FComboGraphNode* ComboGraph::FastFindNodeWithAttackChain(const TArray<TEnumAsByte<AttackType_Enum>>& attackChainToFind) const
 {
 #if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
 	SCOPE_CYCLE_COUNTER(STAT_FastSearchForAttack);
 #endif
 
-	TQueue<FComboGraphNode*> searchQueue;
-
-	FComboGraphNode* nodeToCheck = &rootNode;
+	const FComboGraphNode* foundNode = nullptr;
+	if (ProbePackedAttackChainIndex(attackChainToFind, foundNode))
+	{
+		return foundNode;
+	}
 
-	return SearchGraphStartingFromRootNode(attackChainToFind, nodeToCheck);
+	// The chain is too long for a packed key, walk the graph instead
+	return SearchGraphStartingFromRootNode(attackChainToFind, GetRootNode());
 }
 
-FComboGraphNode* ComboGraph::FastFindNodeWithLastPerformedAttack(TArray<TEnumAsByte<AttackType_Enum>> currentSequence, FComboGraphNode* lastAttackNode)
+const FComboGraphNode* ComboGraph::FastFindNodeWithLastPerformedAttack(const TArray<TEnumAsByte<AttackType_Enum>>& currentSequence, const FComboGraphNode* lastAttackNode) const
 {
 #if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
 	SCOPE_CYCLE_COUNTER(STAT_FastSearchForAttack);
 #endif
 
-	FComboGraphNode* nodeToCheck = lastAttackNode;
+	return SearchGraphStartingFromRootNode(currentSequence, lastAttackNode);
+}
+
+
+const FComboGraphNode* ComboGraph::AdvanceCursor(FComboGraphCursor& cursor, uint8 input) const
+{
+	if (cursor.nodeIndex < 0 || cursor.nodeIndex >= nodeCount)
+	{
+		return nullptr;
+	}
+
+	const int32 nextNodeIndex = FindChildWithInput(cursor.nodeIndex, input);
+	if (nextNodeIndex == INDEX_NONE)
+	{
+		return nullptr;
+	}
 
-	return SearchGraphStartingFromRootNode(currentSequence, nodeToCheck);
+	cursor.nodeIndex = nextNodeIndex;
+	return &nodes[nextNodeIndex];
 }
 
+const FComboGraphNode* ComboGraph::AdvanceCursor(FComboGraphCursor& cursor, uint8 input, EComboMissPolicy missPolicy) const
+{
+	const FComboGraphNode* nextNode = AdvanceCursor(cursor, input);
+	if (nextNode != nullptr || missPolicy != EComboMissPolicy::ResumeAtLongestSuffix)
+	{
+		return nextNode;
+	}
 
-// The logic behind this search pattern is:
-// 1. Consider the root Node the starting point of the search
-// 2. Break down the list of attacks for the chain and search one element at a time
-// 3. At each element starting from the empty root node, search the node's children if they have the same attack as the attack chain at that index of the chain
-// 4.1.a. If a match is found, and if the current depth level is the same as the length of the attack chain then return the match as this is our result
-// 4.1.b If a match is found, but it is not our final result, set it as the new "node to search" and flag that the search can continue. Break out of the for loop as we do not need to check the rest of the children.
-// 4.2 If a match is not found, we can cancel search as there is no attack chain with the given sequence thus far
-// 5. If the next node to search is found, we can continue to the next iteration of the loop. Go to step 3.
-// 6. Break out of the search loop and return a nullptr as the attack chain cannot be found.
-//
-FComboGraphNode* ComboGraph::SearchGraphStartingFromRootNode(TArray<TEnumAsByte<AttackType_Enum>> currentSequence, FComboGraphNode* searchRootNode)
+	return ResumeCursorAfterMiss(cursor, input);
+}
+
+const FComboGraphNode* ComboGraph::ResumeCursorAfterMiss(FComboGraphCursor& cursor, uint8 input) const
 {
-	FDateTime startTime = FDateTime::UtcNow();
+	// The root has no shorter suffix than itself, and its children have already been tried
+	if (cursor.nodeIndex <= 0 || cursor.nodeIndex >= nodeCount)
+	{
+		return nullptr;
+	}
 
-	FComboGraphNode* nodeToCheck = searchRootNode;
+	for (int32 suffixIndex = failureLinks[cursor.nodeIndex]; ; suffixIndex = failureLinks[suffixIndex])
+	{
+		const int32 nextNodeIndex = FindChildWithInput(suffixIndex, input);
+		if (nextNodeIndex != INDEX_NONE)
+		{
+			cursor.nodeIndex = nextNodeIndex;
+			return &nodes[nextNodeIndex];
+		}
 
-	bool nextNodeFound = true;
-	
-	//init the current depth level to 0 if we are starting from a root node search, or to the actual depth level of the attack chain before this point otherwise
-	int currentDepthLevel;
-	if (currentSequence.Num() < 1)
+		if (suffixIndex == 0)
+		{
+			return nullptr;
+		}
+	}
+}
+
+void ComboGraph::GetReachableNodeIndices(int32 nodeIndex, int32 maxDepth, TArray<int32>& outNodeIndices) const
+{
+	if (nodeIndex < 0 || nodeIndex >= nodeCount)
+	{
+		return;
+	}
+
+	// Range of nodes on the level being expanded
+	int32 levelStart = nodeIndex;
+	int32 levelEnd = nodeIndex + 1;
+	for (int32 depth = 0; depth < maxDepth && AdvanceLevelRange(levelStart, levelEnd); depth++)
+	{
+		for (int32 reachableNodeIndex = levelStart; reachableNodeIndex < levelEnd; reachableNodeIndex++)
+		{
+			outNodeIndices.Add(reachableNodeIndex);
+		}
+	}
+}
+
+bool ComboGraph::AdvanceLevelRange(int32& levelStart, int32& levelEnd) const
+{
+	// The children of a run of nodes start where the children of its first node start, and end where the children of the node after its last one start
+	levelStart = nodeRanges[levelStart].childRangeStart;
+	levelEnd = nodeRanges[levelEnd].childRangeStart;
+	return levelStart < levelEnd;
+}
+
+bool ComboGraph::IsReachable(int32 fromNodeIndex, int32 toNodeIndex) const
+{
+	if (fromNodeIndex < 0 || fromNodeIndex >= nodeCount || toNodeIndex < 0 || toNodeIndex >= nodeCount)
+	{
+		return false;
+	}
+
+	const int32 toPreorderIndex = nodeRanges[toNodeIndex].preorderIndex;
+	return toPreorderIndex > nodeRanges[fromNodeIndex].preorderIndex && toPreorderIndex < nodeRanges[fromNodeIndex].subtreeEnd;
+}
+
+int32 ComboGraph::GetInputDistance(int32 fromNodeIndex, int32 toNodeIndex) const
+{
+	if (fromNodeIndex == toNodeIndex)
 	{
-		currentDepthLevel = 0;
+		return (fromNodeIndex >= 0 && fromNodeIndex < nodeCount) ? 0 : INDEX_NONE;
 	}
-	else
+
+	return IsReachable(fromNodeIndex, toNodeIndex) ? nodes[toNodeIndex].depth - nodes[fromNodeIndex].depth : INDEX_NONE;
+}
+
+bool ComboGraph::GetShortestInputSequence(int32 fromNodeIndex, int32 toNodeIndex, TArray<uint8>& outInputs) const
+{
+	outInputs.Reset();
+
+	const int32 inputDistance = GetInputDistance(fromNodeIndex, toNodeIndex);
+	if (inputDistance == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// Walk up from the target, filling the inputs from the back
+	outInputs.SetNumUninitialized(inputDistance);
+	int32 nodeIndex = toNodeIndex;
+	for (int32 inputIndex = inputDistance - 1; inputIndex >= 0; inputIndex--)
 	{
-		currentDepthLevel = currentSequence.Num() - 1;
+		outInputs[inputIndex] = transitionInputs[nodeIndex];
+		nodeIndex = nodes[nodeIndex].parentIndex;
 	}
 
-	while (nextNodeFound == true)
+	return true;
+}
+
+void ComboGraph::GetReachableFinishers(int32 nodeIndex, int32 maxInputs, TArray<int32>& outFinisherIndices) const
+{
+	if (nodeIndex < 0 || nodeIndex >= nodeCount)
 	{
-		nextNodeFound = false;
+		return;
+	}
 
-		for (int childIndex = 0; childIndex < nodeToCheck->childrenNodes.Num(); childIndex++)
+	// The finishers of a level are the ones ranked between the first node of the level and the node after its last one
+	int32 levelStart = nodeIndex;
+	int32 levelEnd = nodeIndex + 1;
+	for (int32 inputs = 0; inputs < maxInputs && AdvanceLevelRange(levelStart, levelEnd); inputs++)
+	{
+		const int32 finisherEnd = nodeRanges[levelEnd].finisherRank;
+		for (int32 finisherIndex = nodeRanges[levelStart].finisherRank; finisherIndex < finisherEnd; finisherIndex++)
 		{
-			// If the current child that is being looked at has the correct input type at the depth level to match the attack chain
-			// use it as the next iteration's parent node
-			if (nodeToCheck->childrenNodes[childIndex]->attackData->requiredSequenceToActivateAttack[currentDepthLevel] == currentSequence[currentDepthLevel])
-			{
-				// Check if we are at the end of the attack chain, return the move we have found now if so
-				if (currentDepthLevel == currentSequence.Num() - 1)
-				{
-#if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
-					//debug statements
-					GEngine->AddOnScreenDebugMessage(1, 5, FColor::Green, TEXT("Time taken to success condition: " + (FString)std::to_string((FDateTime::UtcNow() - startTime).GetTotalMilliseconds()).c_str()));
-#endif
+			outFinisherIndices.Add(finishers[finisherIndex]);
+		}
+	}
+}
 
-					return nodeToCheck->childrenNodes[childIndex];
-				}
+int32 ComboGraph::GetReachableNodeCount(int32 nodeIndex) const
+{
+	if (nodeIndex < 0 || nodeIndex >= nodeCount)
+	{
+		return 0;
+	}
+
+	return nodeRanges[nodeIndex].subtreeEnd - nodeRanges[nodeIndex].preorderIndex - 1;
+}
 
-				// Increase depth level of search, store the next iteration's parent node, and flag that the next iteration can continue
 
-				currentDepthLevel++;
+// The logic behind this search pattern is:
+// 1. Consider the search root node the starting point of the search. Its depth is the number of inputs of the chain that have already been matched
+// 2. Take the input of the chain at the current depth level
+// 3. Scan the transition bytes of the current node's children, which are stored next to each other, for that input
+// 4.1.a. If a match is found, and if the current depth level is the same as the length of the attack chain then return the match as this is our result
+// 4.1.b If a match is found, but it is not our final result, set it as the new "node to search" and go to step 2.
+// 4.2 If a match is not found, we can cancel search as there is no attack chain with the given sequence thus far
+//
+const FComboGraphNode* ComboGraph::SearchGraphStartingFromRootNode(const TArray<TEnumAsByte<AttackType_Enum>>& currentSequence, const FComboGraphNode* searchRootNode) const
+{
+	if (searchRootNode == nullptr)
+	{
+		return nullptr;
+	}
 
-				nodeToCheck = nodeToCheck->childrenNodes[childIndex];
+	int32 nodeIndex = GetNodeIndex(searchRootNode);
 
-				nextNodeFound = true;
+	for (int32 currentDepthLevel = searchRootNode->depth; currentDepthLevel < currentSequence.Num(); currentDepthLevel++)
+	{
+		nodeIndex = FindChildWithInput(nodeIndex, currentSequence[currentDepthLevel]);
 
-				break;
-			}
+		if (nodeIndex == INDEX_NONE)
+		{
+			return nullptr;
 		}
 	}
 
-	#if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
-	//debug statements
-	GEngine->AddOnScreenDebugMessage(1, 5, FColor::Green, TEXT("Time taken to failure condition: " + (FString)std::to_string((FDateTime::UtcNow() - startTime).GetTotalMilliseconds()).c_str()));
-#endif
-	return nullptr;
+	// An empty walk means the sequence did not extend past the search root, which is not an attack to perform
+	if (nodeIndex == GetNodeIndex(searchRootNode))
+	{
+		return nullptr;
+	}
+
+	return &nodes[nodeIndex];
 }
@@ -0,0 +1,476 @@
+#include "ComboGraphBenchmarkCommandlet.h"
+#include "ComboGraph.h"
+#include "FAttackAction_Struct.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTLS.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogComboGraphBenchmark, Log, All);
+
+namespace
+{
+	// Number of lookups timed together for one latency sample. A single lookup is too short for the platform timer to measure on its own.
+	constexpr int32 LookupsPerSample = 32;
+
+	// Receives the results of the timed lookups so that the compiler cannot optimize them away
+	volatile int32 BenchmarkSink = 0;
+
+	/// <summary>
+	/// Shape of one synthetic moveset.
+	/// </summary>
+	struct FComboBenchmarkMoveset
+	{
+		int32 rowCount = 0;
+		int32 maxDepth = 0;
+		int32 branching = 0;
+		int32 alphabetSize = 0;
+	};
+
+	/// <summary>
+	/// Latency percentiles of one kind of lookup, in nanoseconds per lookup.
+	/// </summary>
+	struct FComboBenchmarkPercentiles
+	{
+		double p50 = 0.0;
+		double p90 = 0.0;
+		double p99 = 0.0;
+	};
+
+	/// <summary>
+	/// Everything measured for one moveset.
+	/// </summary>
+	struct FComboBenchmarkResult
+	{
+		FComboBenchmarkMoveset moveset;
+		int32 nodeCount = 0;
+		int32 treeDepth = 0;
+		double buildMillisecondsMedian = 0.0;
+		double buildMillisecondsMin = 0.0;
+		FComboBenchmarkPercentiles findHit;
+		FComboBenchmarkPercentiles findMiss;
+		FComboBenchmarkPercentiles advanceHit;
+		FComboBenchmarkPercentiles advanceMiss;
+		double allocationsPerInput = 0.0;
+		int32 imageBytes = 0;
+		int64 graphBytes = 0;
+		int64 residentBytesDelta = 0;
+	};
+
+	/// <summary>
+	/// One attack chain to look up, along with what advancing a cursor to it takes.
+	/// </summary>
+	struct FComboBenchmarkLookup
+	{
+		TArray<TEnumAsByte<AttackType_Enum>> attackChain;
+
+		// Node reached by the chain without its final input
+		int32 previousNodeIndex = 0;
+
+		// Final input of the chain
+		uint8 finalInput = 0;
+	};
+
+	/// <summary>
+	/// Forwards every call to the allocator it wraps, counting the allocations made by the thread that created it.
+	/// </summary>
+	class FComboCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FComboCountingMalloc(FMalloc* inInnerMalloc)
+			: innerMalloc(inInnerMalloc)
+			, countedThreadId(FPlatformTLS::GetCurrentThreadId())
+		{
+		}
+
+		virtual void* Malloc(SIZE_T count, uint32 alignment) override { CountAllocation(); return innerMalloc->Malloc(count, alignment); }
+		virtual void* TryMalloc(SIZE_T count, uint32 alignment) override { CountAllocation(); return innerMalloc->TryMalloc(count, alignment); }
+		virtual void* Realloc(void* original, SIZE_T count, uint32 alignment) override { CountReallocation(count); return innerMalloc->Realloc(original, count, alignment); }
+		virtual void* TryRealloc(void* original, SIZE_T count, uint32 alignment) override { CountReallocation(count); return innerMalloc->TryRealloc(original, count, alignment); }
+		virtual void Free(void* original) override { innerMalloc->Free(original); }
+		virtual SIZE_T QuantizeSize(SIZE_T count, uint32 alignment) override { return innerMalloc->QuantizeSize(count, alignment); }
+		virtual bool GetAllocationSize(void* original, SIZE_T& sizeOut) override { return innerMalloc->GetAllocationSize(original, sizeOut); }
+		virtual void Trim(bool trimThreadCaches) override { innerMalloc->Trim(trimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { innerMalloc->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { innerMalloc->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& outStats) override { innerMalloc->GetAllocatorStats(outStats); }
+		virtual bool IsInternallyThreadSafe() const override { return innerMalloc->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return innerMalloc->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("ComboCountingMalloc"); }
+
+		int64 GetAllocationCount() const { return allocationCount; }
+
+	private:
+		void CountAllocation()
+		{
+			if (FPlatformTLS::GetCurrentThreadId() == countedThreadId)
+			{
+				allocationCount++;
+			}
+		}
+
+		// Reallocations that grow or create a block are counted, frees through Realloc are not
+		void CountReallocation(SIZE_T count)
+		{
+			if (count > 0)
+			{
+				CountAllocation();
+			}
+		}
+
+		FMalloc* innerMalloc;
+		uint32 countedThreadId;
+
+		// Only changed by the counted thread
+		int64 allocationCount = 0;
+	};
+
+	// Parses a comma separated list of integers, such as -rows=100,1000,10000
+	TArray<int32> ParseIntegerList(const FString& params, const TCHAR* name, int32 defaultValue)
+	{
+		TArray<int32> values;
+
+		FString valueList;
+		if (FParse::Value(*params, name, valueList, false))
+		{
+			TArray<FString> valueStrings;
+			valueList.ParseIntoArray(valueStrings, TEXT(","));
+			for (const FString& valueString : valueStrings)
+			{
+				values.Add(FCString::Atoi(*valueString));
+			}
+		}
+
+		if (values.Num() == 0)
+		{
+			values.Add(defaultValue);
+		}
+		return values;
+	}
+
+	// Builds a moveset table of the given shape. Rows are added breadth first with random inputs, so that every row can be reached.
+	UDataTable* GenerateMoveset(const FComboBenchmarkMoveset& moveset, FRandomStream& random, TArray<TArray<TEnumAsByte<AttackType_Enum>>>& outAttackChains)
+	{
+		UDataTable* movesetTable = NewObject<UDataTable>(GetTransientPackage(), NAME_None, RF_Transient);
+		movesetTable->RowStruct = FAttackAction_Struct::StaticStruct();
+
+		TArray<uint8> alphabet;
+		for (int32 input = 0; input < moveset.alphabetSize; input++)
+		{
+			alphabet.Add(static_cast<uint8>(input));
+		}
+
+		// The empty chain of the root node is expanded first
+		outAttackChains.Reset();
+		outAttackChains.AddDefaulted();
+
+		int32 rowIndex = 0;
+		for (int32 chainIndex = 0; chainIndex < outAttackChains.Num() && rowIndex < moveset.rowCount; chainIndex++)
+		{
+			const TArray<TEnumAsByte<AttackType_Enum>> parentChain = outAttackChains[chainIndex];
+			if (parentChain.Num() >= moveset.maxDepth)
+			{
+				break;
+			}
+
+			// Pick which inputs the children of this move use
+			for (int32 alphabetIndex = alphabet.Num() - 1; alphabetIndex > 0; alphabetIndex--)
+			{
+				alphabet.Swap(alphabetIndex, random.RandRange(0, alphabetIndex));
+			}
+
+			for (int32 childIndex = 0; childIndex < moveset.branching && rowIndex < moveset.rowCount; childIndex++)
+			{
+				FAttackAction_Struct row;
+				row.moveName = FString::Printf(TEXT("Move_%d"), rowIndex);
+				TArray<TEnumAsByte<AttackType_Enum>> attackChain = parentChain;
+				attackChain.Add(static_cast<AttackType_Enum>(alphabet[childIndex]));
+
+				// Alphabets go past the attack types, so the chains are authored as symbols
+				for (const TEnumAsByte<AttackType_Enum> input : attackChain)
+				{
+					row.requiredInputSymbols.Add(input.GetValue());
+				}
+
+				movesetTable->AddRow(FName(*row.moveName), row);
+				outAttackChains.Add(MoveTemp(attackChain));
+				rowIndex++;
+			}
+		}
+
+		// Only the chains of actual rows are returned
+		outAttackChains.RemoveAt(0);
+		return movesetTable;
+	}
+
+	FComboBenchmarkPercentiles GetPercentiles(TArray<double>& samples)
+	{
+		FComboBenchmarkPercentiles percentiles;
+		if (samples.Num() == 0)
+		{
+			return percentiles;
+		}
+
+		samples.Sort();
+		percentiles.p50 = samples[(samples.Num() - 1) * 50 / 100];
+		percentiles.p90 = samples[(samples.Num() - 1) * 90 / 100];
+		percentiles.p99 = samples[(samples.Num() - 1) * 99 / 100];
+		return percentiles;
+	}
+
+	// Times the lookup function over every lookup, in batches of LookupsPerSample
+	template<typename LookupFunctionType>
+	FComboBenchmarkPercentiles MeasureLookupLatency(const TArray<FComboBenchmarkLookup>& lookups, LookupFunctionType&& lookupFunction)
+	{
+		TArray<double> samples;
+		samples.Reserve(lookups.Num() / LookupsPerSample);
+
+		int32 foundNodes = 0;
+		for (int32 sampleStart = 0; sampleStart + LookupsPerSample <= lookups.Num(); sampleStart += LookupsPerSample)
+		{
+			const uint64 startCycles = FPlatformTime::Cycles64();
+			for (int32 lookupIndex = sampleStart; lookupIndex < sampleStart + LookupsPerSample; lookupIndex++)
+			{
+				foundNodes += lookupFunction(lookups[lookupIndex]) != nullptr ? 1 : 0;
+			}
+			const uint64 endCycles = FPlatformTime::Cycles64();
+
+			samples.Add(FPlatformTime::ToSeconds64(endCycles - startCycles) * 1.0e9 / LookupsPerSample);
+		}
+
+		BenchmarkSink = BenchmarkSink + foundNodes;
+		return GetPercentiles(samples);
+	}
+
+	FComboBenchmarkResult RunMovesetBenchmark(const FComboBenchmarkMoveset& moveset, int32 lookupCount, int32 buildCount, FRandomStream& random)
+	{
+		FComboBenchmarkResult result;
+		result.moveset = moveset;
+
+		const uint64 residentBytesBefore = FPlatformMemory::GetStats().UsedPhysical;
+
+		TArray<TArray<TEnumAsByte<AttackType_Enum>>> attackChains;
+		UDataTable* movesetTable = GenerateMoveset(moveset, random, attackChains);
+
+		// Build time
+		ComboGraph graph;
+		TArray<double> buildMilliseconds;
+		for (int32 buildIndex = 0; buildIndex < FMath::Max(1, buildCount); buildIndex++)
+		{
+			const uint64 startCycles = FPlatformTime::Cycles64();
+			graph.CreateComboGraph(movesetTable);
+			const uint64 endCycles = FPlatformTime::Cycles64();
+			buildMilliseconds.Add(FPlatformTime::ToMilliseconds64(endCycles - startCycles));
+		}
+		buildMilliseconds.Sort();
+		result.buildMillisecondsMedian = buildMilliseconds[(buildMilliseconds.Num() - 1) / 2];
+		result.buildMillisecondsMin = buildMilliseconds[0];
+
+		result.nodeCount = graph.GetNodeCount();
+		result.treeDepth = graph.GetTreeDepth();
+		result.imageBytes = graph.GetImageSize();
+		result.graphBytes = static_cast<int64>(graph.GetAllocatedSize());
+		result.residentBytesDelta = static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical) - static_cast<int64>(residentBytesBefore);
+
+		if (attackChains.Num() == 0 || graph.GetNodeCount() == 0)
+		{
+			return result;
+		}
+
+		// Hits are random rows of the moveset. Misses are rows followed by an input that none of their children use.
+		TArray<FComboBenchmarkLookup> hitLookups;
+		TArray<FComboBenchmarkLookup> missLookups;
+		hitLookups.Reserve(lookupCount);
+		missLookups.Reserve(lookupCount);
+
+		for (int32 lookupIndex = 0; lookupIndex < lookupCount; lookupIndex++)
+		{
+			FComboBenchmarkLookup& hitLookup = hitLookups.AddDefaulted_GetRef();
+			hitLookup.attackChain = attackChains[random.RandHelper(attackChains.Num())];
+			hitLookup.finalInput = hitLookup.attackChain.Last().GetValue();
+
+			FComboGraphCursor previousCursor;
+			for (int32 inputIndex = 0; inputIndex < hitLookup.attackChain.Num() - 1; inputIndex++)
+			{
+				graph.AdvanceCursor(previousCursor, hitLookup.attackChain[inputIndex].GetValue());
+			}
+			hitLookup.previousNodeIndex = previousCursor.nodeIndex;
+		}
+
+		const int32 maxMissAttempts = lookupCount * 8;
+		for (int32 missAttempt = 0; missAttempt < maxMissAttempts && missLookups.Num() < lookupCount; missAttempt++)
+		{
+			const FComboBenchmarkLookup& hitLookup = hitLookups[random.RandHelper(hitLookups.Num())];
+
+			FComboBenchmarkLookup missLookup;
+			missLookup.attackChain = hitLookup.attackChain;
+			missLookup.finalInput = static_cast<uint8>(random.RandHelper(moveset.alphabetSize));
+			missLookup.attackChain.Add(static_cast<AttackType_Enum>(missLookup.finalInput));
+
+			const FComboGraphNode* hitNode = graph.FindNodeWithAttackChain(hitLookup.attackChain);
+			missLookup.previousNodeIndex = graph.GetNodeIndex(hitNode);
+
+			if (graph.FindNodeWithAttackChain(missLookup.attackChain) == nullptr)
+			{
+				missLookups.Add(MoveTemp(missLookup));
+			}
+		}
+
+		auto findLookup = [&graph](const FComboBenchmarkLookup& lookup)
+		{
+			return graph.FindNodeWithAttackChain(lookup.attackChain);
+		};
+
+		auto advanceLookup = [&graph](const FComboBenchmarkLookup& lookup)
+		{
+			FComboGraphCursor cursor;
+			cursor.nodeIndex = lookup.previousNodeIndex;
+			return graph.AdvanceCursor(cursor, lookup.finalInput);
+		};
+
+		result.findHit = MeasureLookupLatency(hitLookups, findLookup);
+		result.findMiss = MeasureLookupLatency(missLookups, findLookup);
+		result.advanceHit = MeasureLookupLatency(hitLookups, advanceLookup);
+		result.advanceMiss = MeasureLookupLatency(missLookups, advanceLookup);
+
+		// Allocations per input, counted by swapping in a counting allocator for one more pass over every lookup
+		FMalloc* previousMalloc = GMalloc;
+		FComboCountingMalloc countingMalloc(previousMalloc);
+		GMalloc = &countingMalloc;
+
+		for (const FComboBenchmarkLookup& hitLookup : hitLookups)
+		{
+			BenchmarkSink = BenchmarkSink + (findLookup(hitLookup) != nullptr ? 1 : 0) + (advanceLookup(hitLookup) != nullptr ? 1 : 0);
+		}
+		for (const FComboBenchmarkLookup& missLookup : missLookups)
+		{
+			BenchmarkSink = BenchmarkSink + (findLookup(missLookup) != nullptr ? 1 : 0) + (advanceLookup(missLookup) != nullptr ? 1 : 0);
+		}
+
+		GMalloc = previousMalloc;
+
+		const int32 countedInputs = 2 * (hitLookups.Num() + missLookups.Num());
+		result.allocationsPerInput = countedInputs > 0 ? double(countingMalloc.GetAllocationCount()) / countedInputs : 0.0;
+
+		movesetTable->MarkAsGarbage();
+		return result;
+	}
+
+	FString FormatPercentilesCsv(const FComboBenchmarkPercentiles& percentiles)
+	{
+		return FString::Printf(TEXT("%.2f,%.2f,%.2f"), percentiles.p50, percentiles.p90, percentiles.p99);
+	}
+
+	FString FormatPercentilesJson(const FComboBenchmarkPercentiles& percentiles)
+	{
+		return FString::Printf(TEXT("{ \"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f }"), percentiles.p50, percentiles.p90, percentiles.p99);
+	}
+}
+
+
+UComboGraphBenchmarkCommandlet::UComboGraphBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UComboGraphBenchmarkCommandlet::Main(const FString& Params)
+{
+	const TArray<int32> rowCounts = ParseIntegerList(Params, TEXT("rows="), 1000);
+	const TArray<int32> maxDepths = ParseIntegerList(Params, TEXT("depth="), 8);
+	const TArray<int32> branchingFactors = ParseIntegerList(Params, TEXT("branching="), 3);
+	const TArray<int32> alphabetSizes = ParseIntegerList(Params, TEXT("alphabet="), 3);
+
+	int32 lookupCount = 100000;
+	int32 buildCount = 10;
+	int32 seed = 1;
+	FParse::Value(*Params, TEXT("lookups="), lookupCount);
+	FParse::Value(*Params, TEXT("builds="), buildCount);
+	FParse::Value(*Params, TEXT("seed="), seed);
+
+	FString label = TEXT("unlabeled");
+	FParse::Value(*Params, TEXT("label="), label);
+
+	FString outputDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ComboBenchmarks"));
+	FParse::Value(*Params, TEXT("output="), outputDirectory);
+
+	// Inputs are byte symbols, so alphabets wider than the attack types stand for game specific inputs
+	const int32 maxAlphabetSize = ComboGraph::MaxInputSymbols;
+
+	TArray<FComboBenchmarkResult> results;
+
+	for (const int32 rowCount : rowCounts)
+	{
+		for (const int32 maxDepth : maxDepths)
+		{
+			for (const int32 branching : branchingFactors)
+			{
+				for (const int32 alphabetSize : alphabetSizes)
+				{
+					FComboBenchmarkMoveset moveset;
+					moveset.rowCount = FMath::Max(1, rowCount);
+					moveset.maxDepth = FMath::Max(1, maxDepth);
+					moveset.alphabetSize = FMath::Clamp(alphabetSize, 1, maxAlphabetSize);
+					moveset.branching = FMath::Clamp(branching, 1, moveset.alphabetSize);
+
+					if (moveset.alphabetSize != alphabetSize || moveset.branching != branching)
+					{
+						UE_LOG(LogComboGraphBenchmark, Warning, TEXT("Alphabet size %d and branching %d clamped to %d and %d"), alphabetSize, branching, moveset.alphabetSize, moveset.branching);
+					}
+
+					// Every moveset gets the same random sequence, so that results of a given shape can be compared between runs
+					FRandomStream random(seed);
+					const FComboBenchmarkResult& result = results.Add_GetRef(RunMovesetBenchmark(moveset, FMath::Max(LookupsPerSample, lookupCount), buildCount, random));
+
+					UE_LOG(LogComboGraphBenchmark, Display, TEXT("rows=%d depth=%d branching=%d alphabet=%d: %d nodes, build %.3f ms, find hit p50 %.1f ns, find miss p50 %.1f ns, advance hit p50 %.1f ns, %.3f allocations per input, %lld graph bytes"),
+						moveset.rowCount, moveset.maxDepth, moveset.branching, moveset.alphabetSize, result.nodeCount, result.buildMillisecondsMedian,
+						result.findHit.p50, result.findMiss.p50, result.advanceHit.p50, result.allocationsPerInput, result.graphBytes);
+				}
+			}
+		}
+	}
+
+	FString csv = TEXT("label,rows,maxDepth,branching,alphabet,nodes,treeDepth,buildMsMedian,buildMsMin,")
+		TEXT("findHitP50Ns,findHitP90Ns,findHitP99Ns,findMissP50Ns,findMissP90Ns,findMissP99Ns,")
+		TEXT("advanceHitP50Ns,advanceHitP90Ns,advanceHitP99Ns,advanceMissP50Ns,advanceMissP90Ns,advanceMissP99Ns,")
+		TEXT("allocationsPerInput,imageBytes,graphBytes,residentBytesDelta\n");
+
+	FString json = FString::Printf(TEXT("{\n\t\"label\": \"%s\",\n\t\"imageVersion\": %u,\n\t\"results\": [\n"), *label.ReplaceCharWithEscapedChar(), ComboGraph::ImageVersion);
+
+	for (int32 resultIndex = 0; resultIndex < results.Num(); resultIndex++)
+	{
+		const FComboBenchmarkResult& result = results[resultIndex];
+
+		csv += FString::Printf(TEXT("%s,%d,%d,%d,%d,%d,%d,%.4f,%.4f,%s,%s,%s,%s,%.4f,%d,%lld,%lld\n"),
+			*label, result.moveset.rowCount, result.moveset.maxDepth, result.moveset.branching, result.moveset.alphabetSize, result.nodeCount, result.treeDepth,
+			result.buildMillisecondsMedian, result.buildMillisecondsMin,
+			*FormatPercentilesCsv(result.findHit), *FormatPercentilesCsv(result.findMiss), *FormatPercentilesCsv(result.advanceHit), *FormatPercentilesCsv(result.advanceMiss),
+			result.allocationsPerInput, result.imageBytes, result.graphBytes, result.residentBytesDelta);
+
+		json += FString::Printf(TEXT("\t\t{ \"rows\": %d, \"maxDepth\": %d, \"branching\": %d, \"alphabet\": %d, \"nodes\": %d, \"treeDepth\": %d, ")
+			TEXT("\"buildMsMedian\": %.4f, \"buildMsMin\": %.4f, \"findHitNs\": %s, \"findMissNs\": %s, \"advanceHitNs\": %s, \"advanceMissNs\": %s, ")
+			TEXT("\"allocationsPerInput\": %.4f, \"imageBytes\": %d, \"graphBytes\": %lld, \"residentBytesDelta\": %lld }%s\n"),
+			result.moveset.rowCount, result.moveset.maxDepth, result.moveset.branching, result.moveset.alphabetSize, result.nodeCount, result.treeDepth,
+			result.buildMillisecondsMedian, result.buildMillisecondsMin,
+			*FormatPercentilesJson(result.findHit), *FormatPercentilesJson(result.findMiss), *FormatPercentilesJson(result.advanceHit), *FormatPercentilesJson(result.advanceMiss),
+			result.allocationsPerInput, result.imageBytes, result.graphBytes, result.residentBytesDelta,
+			resultIndex + 1 < results.Num() ? TEXT(",") : TEXT(""));
+	}
+
+	json += TEXT("\t]\n}\n");
+
+	const FString csvFileName = FPaths::Combine(outputDirectory, TEXT("ComboGraphBenchmark.csv"));
+	const FString jsonFileName = FPaths::Combine(outputDirectory, TEXT("ComboGraphBenchmark.json"));
+
+	if (!FFileHelper::SaveStringToFile(csv, *csvFileName) || !FFileHelper::SaveStringToFile(json, *jsonFileName))
+	{
+		UE_LOG(LogComboGraphBenchmark, Error, TEXT("Results could not be written to %s"), *outputDirectory);
+		return 1;
+	}
+
+	UE_LOG(LogComboGraphBenchmark, Display, TEXT("%d movesets benchmarked, results written to %s and %s"), results.Num(), *csvFileName, *jsonFileName);
+	return 0;
+}
@@ -0,0 +1,225 @@
+#include "ComboGraphCache.h"
+#include "ComboMoveSetLibrary.h"
+#include "ComboMovesetAsset.h"
+#include "ComboStaticMoveset.h"
+#include "UObject/StrongObjectPtr.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogComboGraphCache, Log, All);
+
+namespace
+{
+	// A cooked moveset whose image a graph uses in place
+	struct FComboAssetReference
+	{
+		TWeakPtr<const ComboGraph, ESPMode::ThreadSafe> graph;
+		TStrongObjectPtr<UComboMovesetAsset> asset;
+	};
+
+	// Cooked movesets kept alive for the graphs using their images. Graphs are released on any thread, so the assets are let go of on the game thread, before each garbage collection.
+	TArray<FComboAssetReference>& GetAssetReferences()
+	{
+		static TArray<FComboAssetReference> assetReferences;
+		return assetReferences;
+	}
+
+	void ReleaseUnusedAssets()
+	{
+		GetAssetReferences().RemoveAllSwap([](const FComboAssetReference& assetReference)
+		{
+			return !assetReference.graph.IsValid();
+		});
+	}
+}
+
+
+TMap<TObjectKey<UObject>, TWeakPtr<const ComboGraph, ESPMode::ThreadSafe>>& ComboGraphCache::GetCachedGraphs()
+{
+	static TMap<TObjectKey<UObject>, TWeakPtr<const ComboGraph, ESPMode::ThreadSafe>> cachedGraphs;
+	return cachedGraphs;
+}
+
+TArray<ComboGraphCache::FCachedLibrary>& ComboGraphCache::GetCachedLibraries()
+{
+	static TArray<FCachedLibrary> cachedLibraries;
+	return cachedLibraries;
+}
+
+FComboGraphHandle ComboGraphCache::FindOrCreate(const UObject* moveset, TFunctionRef<bool(ComboGraph&)> initializeGraph)
+{
+	check(IsInGameThread());
+
+	TMap<TObjectKey<UObject>, TWeakPtr<const ComboGraph, ESPMode::ThreadSafe>>& cachedGraphs = GetCachedGraphs();
+
+	// Reuse the graph if another component is still holding on to it
+	const TObjectKey<UObject> movesetKey(moveset);
+	if (TWeakPtr<const ComboGraph, ESPMode::ThreadSafe>* cachedGraph = cachedGraphs.Find(movesetKey))
+	{
+		FComboGraphHandle graphHandle = cachedGraph->Pin();
+		if (graphHandle.IsValid())
+		{
+			return graphHandle;
+		}
+	}
+
+	TSharedRef<ComboGraph, ESPMode::ThreadSafe> newGraph = MakeShared<ComboGraph, ESPMode::ThreadSafe>();
+	if (!initializeGraph(newGraph.Get()))
+	{
+		cachedGraphs.Remove(movesetKey);
+		return nullptr;
+	}
+
+	// Graphs of movesets that are no longer used leave stale entries behind, clear them out while we are here
+	for (auto cachedGraphIt = cachedGraphs.CreateIterator(); cachedGraphIt; ++cachedGraphIt)
+	{
+		if (!cachedGraphIt->Value.IsValid())
+		{
+			cachedGraphIt.RemoveCurrent();
+		}
+	}
+
+	cachedGraphs.Add(movesetKey, newGraph);
+	return newGraph;
+}
+
+FComboGraphHandle ComboGraphCache::Acquire(UDataTable* movesetTable)
+{
+	if (movesetTable == nullptr)
+	{
+		return nullptr;
+	}
+
+	return FindOrCreate(movesetTable, [movesetTable](ComboGraph& newGraph)
+	{
+		return newGraph.CreateComboGraph(movesetTable);
+	});
+}
+
+FComboGraphHandle ComboGraphCache::Acquire(UComboMovesetAsset* movesetAsset)
+{
+	if (movesetAsset == nullptr)
+	{
+		return nullptr;
+	}
+
+	bool usesAssetImage = false;
+	FComboGraphHandle graphHandle = FindOrCreate(movesetAsset, [movesetAsset, &usesAssetImage](ComboGraph& newGraph)
+	{
+		if (movesetAsset->InitializeGraph(newGraph))
+		{
+			usesAssetImage = true;
+			return true;
+		}
+
+		// The image is missing or stale, compile the source table instead. Loading the table here would stall the game thread, so it has to be loaded already.
+		UDataTable* movesetTable = movesetAsset->sourceTable.Get();
+		if (movesetTable == nullptr)
+		{
+			UE_LOG(LogComboGraphCache, Error, TEXT("%s has no valid graph image and its source table is not loaded. Save the asset again, or load the table with it."), *movesetAsset->GetPathName());
+			return false;
+		}
+		return newGraph.CreateComboGraph(movesetTable);
+	});
+
+	// Only the component's property points at the asset, and it can be reassigned while the graph is still in use
+	if (usesAssetImage && graphHandle.IsValid())
+	{
+		static const FDelegateHandle preGarbageCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddStatic(&ReleaseUnusedAssets);
+		GetAssetReferences().Add({ graphHandle, TStrongObjectPtr<UComboMovesetAsset>(movesetAsset) });
+	}
+
+	return graphHandle;
+}
+
+FComboGraphHandle ComboGraphCache::Acquire(const FComboStaticMovesetTable* staticMoveset)
+{
+	check(IsInGameThread());
+
+	if (staticMoveset == nullptr)
+	{
+		return nullptr;
+	}
+
+	static TMap<const FComboStaticMovesetTable*, FComboGraphHandle> staticGraphs;
+	if (const FComboGraphHandle* staticGraph = staticGraphs.Find(staticMoveset))
+	{
+		return *staticGraph;
+	}
+
+	TSharedRef<ComboGraph, ESPMode::ThreadSafe> newGraph = MakeShared<ComboGraph, ESPMode::ThreadSafe>();
+	if (!newGraph->InitializeFromStaticMoveset(*staticMoveset))
+	{
+		return nullptr;
+	}
+
+	staticGraphs.Add(staticMoveset, newGraph);
+	return newGraph;
+}
+
+FComboMoveSetLibraryHandle ComboGraphCache::AcquireLibrary(TArrayView<UDataTable* const> movesetTables)
+{
+	check(IsInGameThread());
+
+	if (movesetTables.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	TArray<TObjectKey<UObject>> movesetKeys;
+	movesetKeys.Reserve(movesetTables.Num());
+	for (UDataTable* movesetTable : movesetTables)
+	{
+		movesetKeys.Add(TObjectKey<UObject>(movesetTable));
+	}
+
+	// Only a handful of libraries exist at once, so a linear search is enough. Stale entries are cleared out along the way.
+	TArray<FCachedLibrary>& cachedLibraries = GetCachedLibraries();
+	for (int32 libraryIndex = cachedLibraries.Num() - 1; libraryIndex >= 0; libraryIndex--)
+	{
+		FComboMoveSetLibraryHandle libraryHandle = cachedLibraries[libraryIndex].library.Pin();
+		if (!libraryHandle.IsValid())
+		{
+			cachedLibraries.RemoveAtSwap(libraryIndex);
+		}
+		else if (cachedLibraries[libraryIndex].movesetKeys == movesetKeys)
+		{
+			return libraryHandle;
+		}
+	}
+
+	TSharedRef<ComboMoveSetLibrary, ESPMode::ThreadSafe> newLibrary = MakeShared<ComboMoveSetLibrary, ESPMode::ThreadSafe>();
+	if (!newLibrary->Build(movesetTables))
+	{
+		return nullptr;
+	}
+
+	cachedLibraries.Add({ MoveTemp(movesetKeys), newLibrary });
+	return newLibrary;
+}
+
+void ComboGraphCache::Invalidate(const UObject* moveset)
+{
+	check(IsInGameThread());
+
+	const TObjectKey<UObject> movesetKey(moveset);
+	GetCachedGraphs().Remove(movesetKey);
+	GetCachedLibraries().RemoveAllSwap([&movesetKey](const FCachedLibrary& cachedLibrary)
+	{
+		return cachedLibrary.movesetKeys.Contains(movesetKey);
+	});
+}
+
+int32 ComboGraphCache::GetNumCachedGraphs()
+{
+	check(IsInGameThread());
+
+	int32 numCachedGraphs = 0;
+	for (const TPair<TObjectKey<UObject>, TWeakPtr<const ComboGraph, ESPMode::ThreadSafe>>& cachedGraph : GetCachedGraphs())
+	{
+		if (cachedGraph.Value.IsValid())
+		{
+			numCachedGraphs++;
+		}
+	}
+	return numCachedGraphs;
+}
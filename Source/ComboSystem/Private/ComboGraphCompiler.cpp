@@ -0,0 +1,209 @@
+#include "ComboGraphCompiler.h"
+#include "Misc/MemStack.h"
+
+namespace
+{
+	/// <summary>
+	/// A moveset row waiting to be placed in the graph.
+	/// </summary>
+	struct FComboGraphCompilerRow
+	{
+		FName rowName;
+		FAttackAction_Struct* attackData = nullptr;
+
+		// The input sequence of the row as symbols
+		TArrayView<const uint8> attackChain;
+	};
+
+	// Compares the first chainLength inputs of two attack chains. Returns a negative number, zero, or a positive number like strcmp.
+	int32 CompareAttackChains(TArrayView<const uint8> firstChain, TArrayView<const uint8> secondChain, int32 chainLength)
+	{
+		for (int32 inputIndex = 0; inputIndex < chainLength; inputIndex++)
+		{
+			const int32 difference = int32(firstChain[inputIndex]) - int32(secondChain[inputIndex]);
+			if (difference != 0)
+			{
+				return difference;
+			}
+		}
+		return 0;
+	}
+
+	void AddDiagnostic(TArray<FComboGraphDiagnostic>& outDiagnostics, EComboGraphDiagnosticType type, FName rowName, FName relatedRowName, FString message)
+	{
+		FComboGraphDiagnostic& diagnostic = outDiagnostics.AddDefaulted_GetRef();
+		diagnostic.type = type;
+		diagnostic.rowName = rowName;
+		diagnostic.relatedRowName = relatedRowName;
+		diagnostic.message = MoveTemp(message);
+	}
+}
+
+
+bool ComboGraphCompiler::Compile(UDataTable* movesetTable, ComboGraph& outGraph, TArray<FComboGraphDiagnostic>& outDiagnostics)
+{
+	LLM_SCOPE_BYTAG(ComboGraph);
+
+	outGraph.ReleaseGraphMemory();
+
+	if (movesetTable == nullptr || movesetTable->GetRowMap().Num() == 0)
+	{
+		AddDiagnostic(outDiagnostics, EComboGraphDiagnosticType::EmptyTable, NAME_None, NAME_None, TEXT("The moveset table has no rows"));
+		return false;
+	}
+
+	const UScriptStruct* rowStruct = movesetTable->GetRowStruct();
+	if (rowStruct == nullptr || !rowStruct->IsChildOf(FAttackAction_Struct::StaticStruct()))
+	{
+		AddDiagnostic(outDiagnostics, EComboGraphDiagnosticType::InvalidRowStruct, NAME_None, NAME_None, TEXT("The moveset table rows are not FAttackAction_Struct rows"));
+		return false;
+	}
+
+	// Everything but the move data is only needed while compiling. It comes from the thread's memory stack and is freed all at once when the compile ends.
+	FMemMark scratchMark(FMemStack::Get());
+
+	// Gather every row once, straight from the row map
+	TArray<FComboGraphCompilerRow, TMemStackAllocator<>> rows;
+	rows.Reserve(movesetTable->GetRowMap().Num());
+
+	for (const TPair<FName, uint8*>& rowPair : movesetTable->GetRowMap())
+	{
+		FAttackAction_Struct* attackData = reinterpret_cast<FAttackAction_Struct*>(rowPair.Value);
+		const TArrayView<const uint8> attackChain = attackData->GetRequiredInputs();
+
+		if (attackChain.Num() == 0)
+		{
+			AddDiagnostic(outDiagnostics, EComboGraphDiagnosticType::EmptySequence, rowPair.Key, NAME_None, TEXT("The move has no input sequence and can never be performed"));
+			continue;
+		}
+
+		rows.Add({ rowPair.Key, attackData, attackChain });
+	}
+
+	// Sort by sequence length first, then by the inputs themselves. A stable sort keeps the table order between duplicate sequences, so the first row in the table is the one that is kept.
+	rows.StableSort([](const FComboGraphCompilerRow& firstRow, const FComboGraphCompilerRow& secondRow)
+	{
+		const TArrayView<const uint8> firstChain = firstRow.attackChain;
+		const TArrayView<const uint8> secondChain = secondRow.attackChain;
+
+		if (firstChain.Num() != secondChain.Num())
+		{
+			return firstChain.Num() < secondChain.Num();
+		}
+		return CompareAttackChains(firstChain, secondChain, firstChain.Num()) < 0;
+	});
+
+	TArray<FComboGraphNode, TMemStackAllocator<>> compiledNodes;
+	TArray<uint8, TMemStackAllocator<>> compiledInputs;
+	compiledNodes.Reserve(rows.Num() + 1);
+	compiledInputs.Reserve(rows.Num() + 1);
+
+	TArray<FComboGraphMoveData> compiledMoveData;
+	compiledMoveData.Reserve(rows.Num() + 1);
+
+	// Input sequence of every compiled node, used to compare sequences while matching parents and finding duplicates
+	TArray<TArrayView<const uint8>, TMemStackAllocator<>> compiledChains;
+	compiledChains.Reserve(rows.Num() + 1);
+
+	// The root node is a non-attack representing the starting point of a combo
+	compiledNodes.AddDefaulted();
+	compiledInputs.Add(0);
+	compiledMoveData.AddDefaulted();
+	compiledChains.AddDefaulted();
+
+	// Range of compiled nodes that make up the previous depth level, which holds the parents of the current level
+	int32 parentLevelStart = 0;
+	int32 parentLevelEnd = 1;
+
+	// Range of compiled nodes that make up the current depth level
+	int32 currentLevelStart = 1;
+	int32 currentDepthLevel = 1;
+
+	// Candidate parent for the current row. Rows and parents are both in sorted order, so this only ever moves forward.
+	int32 parentCandidate = 0;
+
+	for (const FComboGraphCompilerRow& row : rows)
+	{
+		const TArrayView<const uint8> attackChain = row.attackChain;
+		const int32 attackChainLength = attackChain.Num();
+
+		// Moving on to a deeper level. The level that was just finished holds the parents of the new one.
+		if (attackChainLength != currentDepthLevel)
+		{
+			if (attackChainLength == currentDepthLevel + 1)
+			{
+				parentLevelStart = currentLevelStart;
+				parentLevelEnd = compiledNodes.Num();
+			}
+			else
+			{
+				// A whole level is missing, so nothing at this length can have a parent
+				parentLevelStart = parentLevelEnd = compiledNodes.Num();
+			}
+
+			currentLevelStart = compiledNodes.Num();
+			currentDepthLevel = attackChainLength;
+			parentCandidate = parentLevelStart;
+		}
+
+		// Rows with the same sequence are next to each other after sorting
+		const int32 lastCompiledIndex = compiledNodes.Num() - 1;
+		if (lastCompiledIndex >= currentLevelStart && CompareAttackChains(compiledChains[lastCompiledIndex], attackChain, attackChainLength) == 0)
+		{
+			AddDiagnostic(outDiagnostics, EComboGraphDiagnosticType::DuplicateSequence, row.rowName, compiledMoveData[lastCompiledIndex].rowName,
+				TEXT("The move uses the same input sequence as ") + compiledMoveData[lastCompiledIndex].rowName.ToString() + TEXT(" and is ignored"));
+			continue;
+		}
+
+		// Find the parent, whose sequence is this row's sequence without its final input. Basic moves with a single input go under the root node.
+		const int32 parentChainLength = attackChainLength - 1;
+		int32 comparison = 1;
+		while (parentCandidate < parentLevelEnd)
+		{
+			comparison = parentChainLength == 0 ? 0 : CompareAttackChains(compiledChains[parentCandidate], attackChain, parentChainLength);
+			if (comparison >= 0)
+			{
+				break;
+			}
+			parentCandidate++;
+		}
+
+		if (parentCandidate >= parentLevelEnd || comparison != 0)
+		{
+			AddDiagnostic(outDiagnostics, EComboGraphDiagnosticType::UnreachableMove, row.rowName, NAME_None,
+				TEXT("No move has the input sequence leading up to this move, so it can never be reached"));
+			continue;
+		}
+
+		const int32 compiledIndex = compiledNodes.Num();
+
+		FComboGraphNode& parentNode = compiledNodes[parentCandidate];
+		if (parentNode.childCount == 0)
+		{
+			parentNode.firstChildIndex = compiledIndex;
+		}
+		parentNode.childCount++;
+
+		FComboGraphNode& newNode = compiledNodes.AddDefaulted_GetRef();
+		newNode.parentIndex = parentCandidate;
+		newNode.depth = attackChainLength;
+
+		FComboGraphMoveData& newMoveData = compiledMoveData.AddDefaulted_GetRef();
+		newMoveData.rowName = row.rowName;
+		newMoveData.moveName = row.attackData->moveName;
+		newMoveData.attackAnimation = row.attackData->attackAnimation;
+
+		compiledInputs.Add(attackChain[attackChainLength - 1]);
+		compiledChains.Add(attackChain);
+	}
+
+	// A graph with nothing but its root node would accept a moveset that can never perform an attack
+	if (compiledNodes.Num() == 1)
+	{
+		AddDiagnostic(outDiagnostics, EComboGraphDiagnosticType::NoValidMoves, NAME_None, NAME_None, TEXT("None of the moveset rows can be performed"));
+		return false;
+	}
+
+	outGraph.InitializeFromCompiledNodes(compiledNodes, compiledInputs, MoveTemp(compiledMoveData));
+	return true;
+}
@@ -0,0 +1,163 @@
+#include "ComboInputRecording.h"
+#include "ComboComponent.h"
+#include "GameFramework/Actor.h"
+#include "HAL/FileManager.h"
+
+namespace
+{
+	// Reads or writes one input field by field, so that the file layout does not depend on struct padding
+	void SerializeInput(FArchive& archive, FComboRecordedInput& input)
+	{
+		archive << input.time;
+		archive << input.previousFrameTime;
+		archive << input.actorIndex;
+		archive << input.input;
+		archive << input.resultNodeIndex;
+	}
+
+	void SerializeActor(FArchive& archive, FComboRecordedActor& actor)
+	{
+		uint8 missPolicy = static_cast<uint8>(actor.missPolicy);
+
+		archive << actor.actorName;
+		archive << actor.moveSetPath;
+		archive << actor.compiledMoveSetPath;
+		archive << actor.staticMoveSet;
+		archive << actor.switchableMoveSetPaths;
+		archive << missPolicy;
+		archive << actor.timeBeforeComboReset;
+		archive << actor.attackRecoveryCooldown;
+		archive << actor.startState.nodeIndex;
+		archive << actor.startState.comboResetDelay;
+		archive << actor.startState.attackCooldownDelay;
+		archive << actor.startState.moveSetIndex;
+
+		actor.missPolicy = static_cast<EComboMissPolicy>(missPolicy);
+	}
+}
+
+
+void ComboInputRecording::RecordInput(const UComboComponent* component, uint16 input, double time, double previousFrameTime)
+{
+	uint16* actorIndex = componentActorIndices.Find(component);
+	if (actorIndex == nullptr)
+	{
+		// Actor indices are stored in 16 bits, further actors are left out of the recording
+		if (actors.Num() > MAX_uint16)
+		{
+			return;
+		}
+
+		const AActor* owner = component->GetOwner();
+
+		FComboRecordedActor& actor = actors.AddDefaulted_GetRef();
+		actor.actorName = owner != nullptr ? owner->GetName() : component->GetName();
+		actor.moveSetPath = component->moveSet != nullptr ? component->moveSet->GetPathName() : FString();
+		actor.compiledMoveSetPath = component->compiledMoveSet != nullptr ? component->compiledMoveSet->GetPathName() : FString();
+		actor.staticMoveSet = component->staticMoveSet.IsNone() ? FString() : component->staticMoveSet.ToString();
+		for (const UDataTable* switchableMoveSet : component->switchableMoveSets)
+		{
+			actor.switchableMoveSetPaths.Add(switchableMoveSet != nullptr ? switchableMoveSet->GetPathName() : FString());
+		}
+		actor.missPolicy = component->missPolicy;
+		actor.timeBeforeComboReset = component->timeBeforeComboReset;
+		actor.attackRecoveryCooldown = component->attackRecoveryCooldown;
+		if (const FComboRecordedStartState* startState = componentStartStates.Find(component))
+		{
+			actor.startState = *startState;
+		}
+
+		actorIndex = &componentActorIndices.Add(component, static_cast<uint16>(actors.Num() - 1));
+	}
+
+	FComboRecordedInput& recordedInput = inputs.AddDefaulted_GetRef();
+	recordedInput.time = time;
+	recordedInput.previousFrameTime = previousFrameTime;
+	recordedInput.actorIndex = *actorIndex;
+	recordedInput.input = input;
+	recordedInput.resultNodeIndex = component->GetComboNodeIndex();
+}
+
+bool ComboInputRecording::WriteToFile(const FString& fileName) const
+{
+	TUniquePtr<FArchive> writer(IFileManager::Get().CreateFileWriter(*fileName));
+	if (!writer.IsValid())
+	{
+		return false;
+	}
+
+	uint32 magic = FileMagic;
+	uint32 version = FileVersion;
+	double recordedDuration = duration;
+	uint32 recordedFrameCount = frameCount;
+	int32 actorCount = actors.Num();
+	int32 inputCount = inputs.Num();
+	*writer << magic;
+	*writer << version;
+	*writer << recordedDuration;
+	*writer << recordedFrameCount;
+	*writer << actorCount;
+	*writer << inputCount;
+
+	for (FComboRecordedActor actor : actors)
+	{
+		SerializeActor(*writer, actor);
+	}
+
+	for (FComboRecordedInput input : inputs)
+	{
+		SerializeInput(*writer, input);
+	}
+
+	return writer->Close();
+}
+
+bool ComboInputRecording::ReadFromFile(const FString& fileName)
+{
+	inputs.Reset();
+	actors.Reset();
+	componentActorIndices.Reset();
+	componentStartStates.Reset();
+
+	TUniquePtr<FArchive> reader(IFileManager::Get().CreateFileReader(*fileName));
+	if (!reader.IsValid())
+	{
+		return false;
+	}
+
+	uint32 magic = 0;
+	uint32 version = 0;
+	int32 actorCount = 0;
+	int32 inputCount = 0;
+	*reader << magic;
+	*reader << version;
+	*reader << duration;
+	*reader << frameCount;
+	*reader << actorCount;
+	*reader << inputCount;
+
+	// Each input takes at least 24 bytes, which bounds the counts by the size of the file before anything is allocated
+	const int64 fileSize = reader->TotalSize();
+	if (reader->IsError() || magic != FileMagic || version != FileVersion || actorCount < 0 || actorCount > MAX_uint16 + 1 || inputCount < 0 || inputCount > fileSize / 24)
+	{
+		return false;
+	}
+
+	actors.SetNum(actorCount);
+	for (FComboRecordedActor& actor : actors)
+	{
+		SerializeActor(*reader, actor);
+	}
+
+	inputs.SetNum(inputCount);
+	for (FComboRecordedInput& input : inputs)
+	{
+		SerializeInput(*reader, input);
+		if (input.actorIndex >= actorCount)
+		{
+			return false;
+		}
+	}
+
+	return !reader->IsError();
+}
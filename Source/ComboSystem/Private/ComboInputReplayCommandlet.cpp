@@ -0,0 +1,199 @@
+#include "ComboInputReplayCommandlet.h"
+#include "ComboComponent.h"
+#include "ComboInputRecording.h"
+#include "ComboMovesetAsset.h"
+#include "ComboWorldSubsystem.h"
+#include "Engine/DataTable.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogComboInputReplay, Log, All);
+
+namespace
+{
+	// Number of divergences logged one by one before they are only counted
+	constexpr int32 MaxLoggedDivergences = 20;
+
+	// Frame length used when the recording does not tell
+	constexpr double DefaultReplayStep = 1.0 / 60.0;
+
+	// Returns the sample at the given percentile of sorted samples
+	double GetPercentile(const TArray<double>& sortedSamples, int32 percentile)
+	{
+		return sortedSamples.Num() > 0 ? sortedSamples[(sortedSamples.Num() - 1) * percentile / 100] : 0.0;
+	}
+}
+
+
+UComboInputReplayCommandlet::UComboInputReplayCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UComboInputReplayCommandlet::Main(const FString& Params)
+{
+	FString recordingFileName;
+	if (!FParse::Value(*Params, TEXT("file="), recordingFileName))
+	{
+		UE_LOG(LogComboInputReplay, Error, TEXT("Usage: -run=ComboInputReplay -file=<input recording> [-clones=<count>] [-step=<seconds>]"));
+		return 1;
+	}
+
+	ComboInputRecording recording;
+	if (!recording.ReadFromFile(recordingFileName))
+	{
+		UE_LOG(LogComboInputReplay, Error, TEXT("%s: could not be read"), *recordingFileName);
+		return 1;
+	}
+
+	int32 cloneCount = 1;
+	FParse::Value(*Params, TEXT("clones="), cloneCount);
+	cloneCount = FMath::Max(cloneCount, 1);
+
+	double replayStep = recording.GetAverageFrameTime() > 0.0 ? recording.GetAverageFrameTime() : DefaultReplayStep;
+	FParse::Value(*Params, TEXT("step="), replayStep);
+	replayStep = FMath::Max(replayStep, UE_KINDA_SMALL_NUMBER);
+
+	// A bare game world is enough: combo components do not tick and montages cannot play without a renderer anyway
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ComboInputReplay"));
+	FWorldContext& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	worldContext.SetCurrentWorld(world);
+	world->InitializeActorsForPlay(FURL());
+	world->BeginPlay();
+
+	UComboWorldSubsystem* comboSubsystem = world->GetSubsystem<UComboWorldSubsystem>();
+	check(comboSubsystem != nullptr);
+
+	// Clones are laid out clone by clone, each holding one component per recorded actor
+	const int32 actorCount = recording.actors.Num();
+	TArray<UComboComponent*> components;
+	components.Reserve(actorCount * cloneCount);
+	for (int32 cloneIndex = 0; cloneIndex < cloneCount; cloneIndex++)
+	{
+		for (const FComboRecordedActor& recordedActor : recording.actors)
+		{
+			AActor* actor = world->SpawnActor<AActor>();
+			UComboComponent* component = NewObject<UComboComponent>(actor);
+			component->moveSet = !recordedActor.moveSetPath.IsEmpty() ? LoadObject<UDataTable>(nullptr, *recordedActor.moveSetPath) : nullptr;
+			component->compiledMoveSet = !recordedActor.compiledMoveSetPath.IsEmpty() ? LoadObject<UComboMovesetAsset>(nullptr, *recordedActor.compiledMoveSetPath) : nullptr;
+			component->staticMoveSet = !recordedActor.staticMoveSet.IsEmpty() ? FName(*recordedActor.staticMoveSet) : NAME_None;
+			for (const FString& switchableMoveSetPath : recordedActor.switchableMoveSetPaths)
+			{
+				component->switchableMoveSets.Add(!switchableMoveSetPath.IsEmpty() ? LoadObject<UDataTable>(nullptr, *switchableMoveSetPath) : nullptr);
+			}
+			component->missPolicy = recordedActor.missPolicy;
+			component->timeBeforeComboReset = recordedActor.timeBeforeComboReset;
+			component->attackRecoveryCooldown = recordedActor.attackRecoveryCooldown;
+			component->RegisterComponent();
+			components.Add(component);
+		}
+	}
+
+	UE_LOG(LogComboInputReplay, Display, TEXT("%s: replaying %d inputs of %d actors on %d clones, %.2f ms per frame"),
+		*recordingFileName, recording.inputs.Num(), actorCount, cloneCount, replayStep * 1000.0);
+
+	TArray<double> inputLatencies;
+	inputLatencies.Reserve(recording.inputs.Num() * cloneCount);
+	uint64 timerCycles = 0;
+	int32 replayedFrames = 0;
+	int32 divergenceCount = 0;
+
+	// Recordings can start mid-combo, so every clone starts where its recorded actor was
+	for (int32 componentIndex = 0; componentIndex < components.Num(); componentIndex++)
+	{
+		comboSubsystem->RestoreRecordedStartState(components[componentIndex], recording.actors[componentIndex % actorCount].startState);
+	}
+
+	auto updateComboTimers = [&]()
+	{
+		const uint64 timerStartCycles = FPlatformTime::Cycles64();
+		comboSubsystem->Tick(replayStep);
+		timerCycles += FPlatformTime::Cycles64() - timerStartCycles;
+		replayedFrames++;
+	};
+
+	// Within a frame, inputs are received before the combo timers are updated, as in a running game
+	const double replayStartTime = world->GetTimeSeconds();
+	const uint64 replayStartCycles = FPlatformTime::Cycles64();
+	int32 nextInputIndex = 0;
+	while (nextInputIndex < recording.inputs.Num())
+	{
+		const double frameTime = recording.inputs[nextInputIndex].time;
+		const double previousFrameTime = replayStartTime + recording.inputs[nextInputIndex].previousFrameTime;
+
+		// Frames without inputs advance in fixed steps, only to keep the timers busy as in a running game
+		while (world->TimeSeconds + replayStep < previousFrameTime)
+		{
+			world->TimeSeconds += replayStep;
+			updateComboTimers();
+		}
+
+		// The timers are updated at the recorded frame times around the input, so that every deadline fires on the same side of it as in the recorded session
+		if (world->TimeSeconds < previousFrameTime)
+		{
+			world->TimeSeconds = previousFrameTime;
+			updateComboTimers();
+		}
+		world->TimeSeconds = FMath::Max(world->TimeSeconds, replayStartTime + frameTime);
+
+		for (; nextInputIndex < recording.inputs.Num() && recording.inputs[nextInputIndex].time == frameTime; nextInputIndex++)
+		{
+			const FComboRecordedInput& recordedInput = recording.inputs[nextInputIndex];
+			for (int32 cloneIndex = 0; cloneIndex < cloneCount; cloneIndex++)
+			{
+				UComboComponent* component = components[cloneIndex * actorCount + recordedInput.actorIndex];
+
+				const uint64 inputStartCycles = FPlatformTime::Cycles64();
+				if (ComboRollback::IsSwitchMoveSetInput(recordedInput.input))
+				{
+					component->SwitchMoveSet(recordedInput.input - ComboRollback::SwitchMoveSetInputBase);
+				}
+				else
+				{
+					component->AttackInput(static_cast<AttackType_Enum>(recordedInput.input));
+				}
+				inputLatencies.Add(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - inputStartCycles) * 1.0e6);
+
+				if (component->GetComboNodeIndex() != recordedInput.resultNodeIndex)
+				{
+					if (divergenceCount < MaxLoggedDivergences)
+					{
+						UE_LOG(LogComboInputReplay, Warning, TEXT("Input %d at %.3f s, %s clone %d: on node %d, recorded node %d"), nextInputIndex, recordedInput.time,
+							*recording.actors[recordedInput.actorIndex].actorName, cloneIndex, component->GetComboNodeIndex(), recordedInput.resultNodeIndex);
+					}
+					divergenceCount++;
+				}
+			}
+		}
+
+		updateComboTimers();
+	}
+	const double replaySeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - replayStartCycles);
+
+	inputLatencies.Sort();
+	const double maxLatency = inputLatencies.Num() > 0 ? inputLatencies.Last() : 0.0;
+	UE_LOG(LogComboInputReplay, Display, TEXT("%d inputs over %d frames in %.3f s: %.0f inputs per second"),
+		inputLatencies.Num(), replayedFrames, replaySeconds, replaySeconds > 0.0 ? inputLatencies.Num() / replaySeconds : 0.0);
+	UE_LOG(LogComboInputReplay, Display, TEXT("Input latency: p50 %.2f us, p90 %.2f us, p99 %.2f us, max %.2f us"),
+		GetPercentile(inputLatencies, 50), GetPercentile(inputLatencies, 90), GetPercentile(inputLatencies, 99), maxLatency);
+	UE_LOG(LogComboInputReplay, Display, TEXT("Combo timers: %.2f us per frame"),
+		replayedFrames > 0 ? FPlatformTime::ToSeconds64(timerCycles) * 1.0e6 / replayedFrames : 0.0);
+
+	if (divergenceCount > 0)
+	{
+		UE_LOG(LogComboInputReplay, Error, TEXT("%d of %d inputs diverged from the recording"), divergenceCount, inputLatencies.Num());
+	}
+	else
+	{
+		UE_LOG(LogComboInputReplay, Display, TEXT("Every input reached the recorded node"));
+	}
+
+	GEngine->DestroyWorldContext(world);
+	world->DestroyWorld(false);
+
+	return divergenceCount == 0 ? 0 : 1;
+}
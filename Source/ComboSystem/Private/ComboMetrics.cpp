@@ -0,0 +1,114 @@
+#include "ComboMetrics.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_STAT(STAT_ComboAttackLookup);
+DEFINE_STAT(STAT_ComboMontageDispatch);
+DEFINE_STAT(STAT_ComboDelegateBroadcast);
+DEFINE_STAT(STAT_ComboAttackLookups);
+DEFINE_STAT(STAT_ComboAttackLookupHits);
+DEFINE_STAT(STAT_ComboAttackLookupMisses);
+DEFINE_STAT(STAT_ComboCompletions);
+DEFINE_STAT(STAT_ComboBreaks);
+DEFINE_STAT(STAT_ComboLookupHitRatio);
+DEFINE_STAT(STAT_ComboCompletionRate);
+DEFINE_STAT(STAT_ComboBreakRate);
+DEFINE_STAT(STAT_ComboResolvedDepth1);
+DEFINE_STAT(STAT_ComboResolvedDepth2);
+DEFINE_STAT(STAT_ComboResolvedDepth3);
+DEFINE_STAT(STAT_ComboResolvedDepth4);
+DEFINE_STAT(STAT_ComboResolvedDepth5Plus);
+
+UE_TRACE_CHANNEL_DEFINE(ComboChannel);
+
+UE_TRACE_EVENT_BEGIN(ComboSystem, AttackLookup)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(int32, NodeIndex)
+	UE_TRACE_EVENT_FIELD(uint16, Depth)
+	UE_TRACE_EVENT_FIELD(bool, Hit)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(ComboSystem, ComboEnded)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint16, Depth)
+	UE_TRACE_EVENT_FIELD(bool, Completed)
+UE_TRACE_EVENT_END()
+
+namespace
+{
+	// Session totals the rates are computed from. Only touched on the game thread.
+	uint64 TotalAttackLookups = 0;
+	uint64 TotalAttackLookupHits = 0;
+	uint64 TotalCompletedCombos = 0;
+	uint64 TotalBrokenCombos = 0;
+
+	TAutoConsoleVariable<bool> CVarComboShowDebugMessages(
+		TEXT("combo.ShowDebugMessages"),
+		false,
+		TEXT("Shows a message on screen for every attack input, attack, moveset switch and combo reset. Off by default, since the messages are formatted on every input. The combo event recorder keeps the same information without the cost."),
+		ECVF_Cheat);
+}
+
+
+void ComboMetrics::RecordAttackLookup(bool hit, int32 nodeIndex, int32 resolvedDepth)
+{
+	check(IsInGameThread());
+
+	TotalAttackLookups++;
+	INC_DWORD_STAT(STAT_ComboAttackLookups);
+
+	if (hit)
+	{
+		TotalAttackLookupHits++;
+		INC_DWORD_STAT(STAT_ComboAttackLookupHits);
+
+		switch (resolvedDepth)
+		{
+		case 1: INC_DWORD_STAT(STAT_ComboResolvedDepth1); break;
+		case 2: INC_DWORD_STAT(STAT_ComboResolvedDepth2); break;
+		case 3: INC_DWORD_STAT(STAT_ComboResolvedDepth3); break;
+		case 4: INC_DWORD_STAT(STAT_ComboResolvedDepth4); break;
+		default: INC_DWORD_STAT(STAT_ComboResolvedDepth5Plus); break;
+		}
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_ComboAttackLookupMisses);
+	}
+
+	SET_FLOAT_STAT(STAT_ComboLookupHitRatio, float(double(TotalAttackLookupHits) / double(TotalAttackLookups)));
+
+	UE_TRACE_LOG(ComboSystem, AttackLookup, ComboChannel)
+		<< AttackLookup.Cycle(FPlatformTime::Cycles64())
+		<< AttackLookup.NodeIndex(nodeIndex)
+		<< AttackLookup.Depth(uint16(resolvedDepth))
+		<< AttackLookup.Hit(hit);
+}
+
+void ComboMetrics::RecordComboEnded(bool completed, int32 finalDepth)
+{
+	check(IsInGameThread());
+
+	if (completed)
+	{
+		TotalCompletedCombos++;
+		INC_DWORD_STAT(STAT_ComboCompletions);
+	}
+	else
+	{
+		TotalBrokenCombos++;
+		INC_DWORD_STAT(STAT_ComboBreaks);
+	}
+
+	SET_FLOAT_STAT(STAT_ComboCompletionRate, float(double(TotalCompletedCombos) / double(TotalCompletedCombos + TotalBrokenCombos)));
+	SET_FLOAT_STAT(STAT_ComboBreakRate, float(double(TotalBrokenCombos) / double(TotalCompletedCombos + TotalBrokenCombos)));
+
+	UE_TRACE_LOG(ComboSystem, ComboEnded, ComboChannel)
+		<< ComboEnded.Cycle(FPlatformTime::Cycles64())
+		<< ComboEnded.Depth(uint16(finalDepth))
+		<< ComboEnded.Completed(completed);
+}
+
+bool ComboMetrics::ShowDebugMessages()
+{
+	return CVarComboShowDebugMessages.GetValueOnGameThread();
+}
@@ -0,0 +1,317 @@
+#include "ComboMoveSetLibrary.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogComboMoveSetLibrary, Log, All);
+
+namespace
+{
+	// Memory taken by the strings of some move data, which the arrays holding the move data do not count
+	SIZE_T GetMoveNamesAllocatedSize(TArrayView<const FComboGraphMoveData> moves)
+	{
+		SIZE_T allocatedSize = 0;
+		for (const FComboGraphMoveData& move : moves)
+		{
+			allocatedSize += move.moveName.GetAllocatedSize();
+		}
+		return allocatedSize;
+	}
+}
+
+
+bool ComboMoveSetLibrary::Build(TArrayView<UDataTable* const> movesetTables)
+{
+	graphs.Reset();
+	moveSetShapeIndices.Reset();
+	shapes.Reset();
+	sharedMoveData.Reset();
+	shapeCount = 0;
+	canonicalNodeCount = 0;
+	unsharedAllocatedSize = 0;
+
+	if (movesetTables.Num() == 0)
+	{
+		return false;
+	}
+
+	TArray<TSharedRef<ComboGraph, ESPMode::ThreadSafe>> builtGraphs;
+	SIZE_T builtAllocatedSize = 0;
+	for (UDataTable* movesetTable : movesetTables)
+	{
+		TSharedRef<ComboGraph, ESPMode::ThreadSafe> builtGraph = MakeShared<ComboGraph, ESPMode::ThreadSafe>();
+		if (movesetTable == nullptr || !builtGraph->CreateComboGraph(movesetTable))
+		{
+			return false;
+		}
+		builtGraphs.Add(builtGraph);
+		builtAllocatedSize += builtGraph->GetAllocatedSize();
+	}
+
+	// Intern the move data by move name and animation, whatever the chain or the table a node comes from.
+	// The row is the only part of the move data that differs between nodes performing the same move, and it is only read to cook assets, which are never built from a library.
+	TArray<FComboGraphMoveData> libraryMoves;
+	TMap<TTuple<FString, FSoftObjectPath>, int32> libraryMoveIndices;
+	TArray<TArray<int32>> graphMoveIndices;
+	for (const TSharedRef<ComboGraph, ESPMode::ThreadSafe>& builtGraph : builtGraphs)
+	{
+		TArray<int32>& nodeMoveIndices = graphMoveIndices.AddDefaulted_GetRef();
+		nodeMoveIndices.SetNumUninitialized(builtGraph->GetNodeCount());
+
+		for (int32 nodeIndex = 0; nodeIndex < builtGraph->GetNodeCount(); nodeIndex++)
+		{
+			const FComboGraphMoveData& nodeMove = builtGraph->GetMoveData(builtGraph->GetNode(nodeIndex));
+			const TTuple<FString, FSoftObjectPath> moveKey(nodeMove.moveName, nodeMove.attackAnimation.ToSoftObjectPath());
+
+			if (const int32* moveIndex = libraryMoveIndices.Find(moveKey))
+			{
+				nodeMoveIndices[nodeIndex] = *moveIndex;
+			}
+			else
+			{
+				nodeMoveIndices[nodeIndex] = libraryMoves.Add(nodeMove);
+				libraryMoveIndices.Add(moveKey, nodeMoveIndices[nodeIndex]);
+			}
+		}
+	}
+	libraryMoves.Shrink();
+
+	// Movesets with the same button layout compile to the same shape, whatever their moves, and a table identical to an earlier one, with the same shape and the same moves,
+	// shares its whole graph. There are only a handful of movesets, so they are compared one by one.
+	TArray<TSharedRef<ComboGraph, ESPMode::ThreadSafe>> shapeGraphs;
+	TArray<int32> builtShapeIndices;
+	TArray<int32> identicalMoveSetIndices;
+	for (int32 moveSetIndex = 0; moveSetIndex < builtGraphs.Num(); moveSetIndex++)
+	{
+		const TSharedRef<ComboGraph, ESPMode::ThreadSafe>& builtGraph = builtGraphs[moveSetIndex];
+		int32 shapeIndex = shapeGraphs.IndexOfByPredicate([&builtGraph](const TSharedRef<ComboGraph, ESPMode::ThreadSafe>& shapeGraph) { return HasSameShape(*shapeGraph, *builtGraph); });
+
+		int32 identicalMoveSetIndex = INDEX_NONE;
+		for (int32 earlierMoveSetIndex = 0; shapeIndex != INDEX_NONE && earlierMoveSetIndex < moveSetIndex; earlierMoveSetIndex++)
+		{
+			if (identicalMoveSetIndices[earlierMoveSetIndex] == INDEX_NONE && builtShapeIndices[earlierMoveSetIndex] == shapeIndex && graphMoveIndices[earlierMoveSetIndex] == graphMoveIndices[moveSetIndex])
+			{
+				identicalMoveSetIndex = earlierMoveSetIndex;
+				break;
+			}
+		}
+
+		if (shapeIndex == INDEX_NONE)
+		{
+			shapeIndex = shapeGraphs.Add(builtGraph);
+		}
+		builtShapeIndices.Add(shapeIndex);
+		identicalMoveSetIndices.Add(identicalMoveSetIndex);
+	}
+
+	// Interned move data costs an entry index per node, which only pays off when enough nodes share their moves. Movesets whose moves are all different keep their own.
+	SIZE_T ownMoveDataSize = 0;
+	SIZE_T internedMoveDataSize = libraryMoves.GetAllocatedSize() + GetMoveNamesAllocatedSize(libraryMoves);
+	for (int32 moveSetIndex = 0; moveSetIndex < builtGraphs.Num(); moveSetIndex++)
+	{
+		if (identicalMoveSetIndices[moveSetIndex] == INDEX_NONE)
+		{
+			ownMoveDataSize += builtGraphs[moveSetIndex]->GetAllocatedSize() - builtGraphs[moveSetIndex]->GetImageSize();
+			internedMoveDataSize += graphMoveIndices[moveSetIndex].GetAllocatedSize();
+		}
+	}
+
+	const bool internMoveData = internedMoveDataSize < ownMoveDataSize;
+	TSharedPtr<const TArray<FComboGraphMoveData>, ESPMode::ThreadSafe> libraryMoveData;
+	if (internMoveData)
+	{
+		// Every move is known by now, so the shared move data never moves once the graphs point into it
+		libraryMoveData = MakeShared<TArray<FComboGraphMoveData>, ESPMode::ThreadSafe>(MoveTemp(libraryMoves));
+		sharedMoveData = libraryMoveData;
+	}
+
+	for (int32 moveSetIndex = 0; moveSetIndex < builtGraphs.Num(); moveSetIndex++)
+	{
+		if (identicalMoveSetIndices[moveSetIndex] != INDEX_NONE)
+		{
+			graphs.Add(graphs[identicalMoveSetIndices[moveSetIndex]]);
+			continue;
+		}
+
+		const TSharedRef<ComboGraph, ESPMode::ThreadSafe>& builtGraph = builtGraphs[moveSetIndex];
+		if (internMoveData)
+		{
+			builtGraph->ShareMoveData(libraryMoveData.ToSharedRef(), MoveTemp(graphMoveIndices[moveSetIndex]));
+		}
+
+		const TSharedRef<ComboGraph, ESPMode::ThreadSafe>& shapeGraph = shapeGraphs[builtShapeIndices[moveSetIndex]];
+		if (shapeGraph != builtGraph)
+		{
+			builtGraph->ShareImage(shapeGraph);
+		}
+		graphs.Add(builtGraph);
+	}
+
+	shapeCount = shapeGraphs.Num();
+
+	// The graph handles are held whether or not the graphs are shared
+	unsharedAllocatedSize = builtAllocatedSize + graphs.GetAllocatedSize();
+
+	// With a single shape, every chain is at the same node index in every moveset, and switching keeps the cursor where it is
+	if (shapeGraphs.Num() > 1)
+	{
+		BuildCursorMaps(shapeGraphs, builtShapeIndices);
+
+		// The maps grow with the number of shapes times the chains of every shape, which outweighs the sharing when the layouts have little in common.
+		// Switching then walks the chain through the target moveset instead, so that the library never takes more memory than the graphs on their own.
+		if (GetAllocatedSize() > unsharedAllocatedSize)
+		{
+			UE_LOG(LogComboMoveSetLibrary, Verbose, TEXT("Cursor maps of %d canonical nodes left out, they would take more memory than the library saves"), canonicalNodeCount);
+			moveSetShapeIndices.Empty();
+			shapes.Empty();
+			canonicalNodeCount = 0;
+		}
+	}
+
+	check(GetAllocatedSize() <= unsharedAllocatedSize);
+
+	UE_LOG(LogComboMoveSetLibrary, Verbose, TEXT("%d movesets built with %d shapes, %d interned moves and %d canonical nodes: %llu bytes, %llu bytes compiled on their own"),
+		graphs.Num(), shapeCount, GetNumMoves(), canonicalNodeCount, uint64(GetAllocatedSize()), uint64(unsharedAllocatedSize));
+
+	return true;
+}
+
+void ComboMoveSetLibrary::BuildCursorMaps(const TArray<TSharedRef<ComboGraph, ESPMode::ThreadSafe>>& shapeGraphs, const TArray<int32>& builtShapeIndices)
+{
+	moveSetShapeIndices = builtShapeIndices;
+	shapes.SetNum(shapeGraphs.Num());
+
+	// Merge the chains of every shape into the canonical space. Parents come before their children in every graph, so the canonical node of a parent
+	// is known by the time its children are reached, and canonical nodes also come after their parents.
+	TArray<int32> canonicalParentIndices = { INDEX_NONE };
+	TArray<uint8> canonicalInputs = { 0 };
+	TMap<uint64, int32> canonicalChildIndices;
+	for (int32 shapeIndex = 0; shapeIndex < shapeGraphs.Num(); shapeIndex++)
+	{
+		const ComboGraph& shapeGraph = *shapeGraphs[shapeIndex];
+		TArray<int32>& canonicalNodeIndices = shapes[shapeIndex].canonicalNodeIndices;
+		canonicalNodeIndices.SetNumUninitialized(shapeGraph.GetNodeCount());
+		canonicalNodeIndices[0] = 0;
+
+		for (int32 nodeIndex = 1; nodeIndex < shapeGraph.GetNodeCount(); nodeIndex++)
+		{
+			const int32 canonicalParentIndex = canonicalNodeIndices[shapeGraph.GetNode(nodeIndex)->parentIndex];
+			const uint8 nodeInput = shapeGraph.GetTransitionInput(nodeIndex);
+
+			const uint64 childKey = (uint64(canonicalParentIndex) << 8) | nodeInput;
+			const int32* canonicalChildIndex = canonicalChildIndices.Find(childKey);
+			if (canonicalChildIndex == nullptr)
+			{
+				canonicalChildIndex = &canonicalChildIndices.Add(childKey, canonicalParentIndices.Num());
+				canonicalParentIndices.Add(canonicalParentIndex);
+				canonicalInputs.Add(nodeInput);
+			}
+			canonicalNodeIndices[nodeIndex] = *canonicalChildIndex;
+		}
+	}
+	canonicalNodeCount = canonicalParentIndices.Num();
+
+	// Run every canonical chain through every shape, following its failure links on a miss, so that each canonical node maps to the longest suffix of its chain
+	// that the shape has. Each node only costs one step from its parent's mapping.
+	for (int32 shapeIndex = 0; shapeIndex < shapeGraphs.Num(); shapeIndex++)
+	{
+		const ComboGraph& shapeGraph = *shapeGraphs[shapeIndex];
+		TArray<int32>& suffixNodeIndices = shapes[shapeIndex].suffixNodeIndices;
+		suffixNodeIndices.SetNumZeroed(canonicalNodeCount);
+
+		for (int32 canonicalNodeIndex = 1; canonicalNodeIndex < canonicalNodeCount; canonicalNodeIndex++)
+		{
+			FComboGraphCursor cursor;
+			cursor.nodeIndex = suffixNodeIndices[canonicalParentIndices[canonicalNodeIndex]];
+			if (shapeGraph.AdvanceCursor(cursor, canonicalInputs[canonicalNodeIndex], EComboMissPolicy::ResumeAtLongestSuffix) == nullptr)
+			{
+				cursor.Reset();
+			}
+			suffixNodeIndices[canonicalNodeIndex] = cursor.nodeIndex;
+		}
+	}
+}
+
+bool ComboMoveSetLibrary::HasSameShape(const ComboGraph& graph, const ComboGraph& otherGraph)
+{
+	if (graph.GetImageSize() != otherGraph.GetImageSize() || graph.GetNodeCount() != otherGraph.GetNodeCount())
+	{
+		return false;
+	}
+
+	const uint8* image = reinterpret_cast<const uint8*>(graph.imageHeader);
+	const uint8* otherImage = reinterpret_cast<const uint8*>(otherGraph.imageHeader);
+	return FMemory::Memcmp(image + sizeof(FComboGraphImageHeader), otherImage + sizeof(FComboGraphImageHeader), graph.GetImageSize() - sizeof(FComboGraphImageHeader)) == 0;
+}
+
+int32 ComboMoveSetLibrary::FindLongestSuffixNode(const ComboGraph& fromGraph, int32 nodeIndex, const ComboGraph& toGraph)
+{
+	// Read the chain back from the node, then run it through the target graph from the root, following its failure links on a miss like the cursor maps do
+	TArray<uint8, TInlineAllocator<64>> chainInputs;
+	for (int32 chainNodeIndex = nodeIndex; chainNodeIndex > 0; chainNodeIndex = fromGraph.GetNode(chainNodeIndex)->parentIndex)
+	{
+		chainInputs.Add(fromGraph.GetTransitionInput(chainNodeIndex));
+	}
+
+	FComboGraphCursor cursor;
+	for (int32 inputIndex = chainInputs.Num() - 1; inputIndex >= 0; inputIndex--)
+	{
+		if (toGraph.AdvanceCursor(cursor, chainInputs[inputIndex], EComboMissPolicy::ResumeAtLongestSuffix) == nullptr)
+		{
+			cursor.Reset();
+		}
+	}
+	return cursor.nodeIndex;
+}
+
+int32 ComboMoveSetLibrary::MapCursor(int32 fromMoveSetIndex, int32 toMoveSetIndex, int32 nodeIndex, EComboMissPolicy missPolicy) const
+{
+	if (!graphs.IsValidIndex(fromMoveSetIndex) || !graphs.IsValidIndex(toMoveSetIndex))
+	{
+		return 0;
+	}
+
+	// Graphs of the same shape share their image, and have the same chain at every node index
+	const ComboGraph& fromGraph = *graphs[fromMoveSetIndex];
+	const ComboGraph& toGraph = *graphs[toMoveSetIndex];
+	if (fromGraph.imageHeader == toGraph.imageHeader)
+	{
+		return nodeIndex;
+	}
+
+	if (fromGraph.GetNode(nodeIndex) == nullptr)
+	{
+		return 0;
+	}
+
+	const int32 mappedNodeIndex = shapes.Num() > 0
+		? shapes[moveSetShapeIndices[toMoveSetIndex]].suffixNodeIndices[shapes[moveSetShapeIndices[fromMoveSetIndex]].canonicalNodeIndices[nodeIndex]]
+		: FindLongestSuffixNode(fromGraph, nodeIndex, toGraph);
+
+	// The mapping is the whole chain only when it lands as deep as it started
+	const bool wholeChain = toGraph.GetNode(mappedNodeIndex)->depth == fromGraph.GetNode(nodeIndex)->depth;
+	return (wholeChain || missPolicy == EComboMissPolicy::ResumeAtLongestSuffix) ? mappedNodeIndex : 0;
+}
+
+SIZE_T ComboMoveSetLibrary::GetAllocatedSize() const
+{
+	SIZE_T allocatedSize = graphs.GetAllocatedSize() + moveSetShapeIndices.GetAllocatedSize() + shapes.GetAllocatedSize();
+
+	for (const FGraphShape& shape : shapes)
+	{
+		allocatedSize += shape.canonicalNodeIndices.GetAllocatedSize() + shape.suffixNodeIndices.GetAllocatedSize();
+	}
+
+	// Graphs shared by identical tables are only counted once
+	for (int32 moveSetIndex = 0; moveSetIndex < graphs.Num(); moveSetIndex++)
+	{
+		if (graphs.IndexOfByKey(graphs[moveSetIndex]) == moveSetIndex)
+		{
+			allocatedSize += graphs[moveSetIndex]->GetAllocatedSize();
+		}
+	}
+
+	if (sharedMoveData.IsValid())
+	{
+		allocatedSize += sharedMoveData->GetAllocatedSize() + GetMoveNamesAllocatedSize(*sharedMoveData);
+	}
+
+	return allocatedSize;
+}
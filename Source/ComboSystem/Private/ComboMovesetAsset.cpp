@@ -0,0 +1,168 @@
+#include "ComboMovesetAsset.h"
+#include "ComboGraphCache.h"
+#include "UObject/ObjectSaveContext.h"
+
+namespace
+{
+	// Whether two lists of move data are the same, so that graphs using the first one would read the same data from the second
+	bool IsSameMoveData(const TArray<FComboGraphMoveData>& a, const TArray<FComboGraphMoveData>& b)
+	{
+		if (a.Num() != b.Num())
+		{
+			return false;
+		}
+
+		for (int32 moveIndex = 0; moveIndex < a.Num(); moveIndex++)
+		{
+			if (a[moveIndex].rowName != b[moveIndex].rowName || a[moveIndex].moveName != b[moveIndex].moveName || a[moveIndex].attackAnimation != b[moveIndex].attackAnimation)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+
+bool UComboMovesetAsset::RebuildFromSourceTable()
+{
+	compileDiagnostics.Reset();
+
+	// The stored image is only replaced once a new one has been compiled, so a failed rebuild leaves the asset as it was
+	UDataTable* movesetTable = sourceTable.LoadSynchronous();
+	if (movesetTable == nullptr)
+	{
+		FComboGraphDiagnostic& diagnostic = compileDiagnostics.AddDefaulted_GetRef();
+		diagnostic.type = EComboGraphDiagnosticType::EmptyTable;
+		diagnostic.message = TEXT("The source table could not be loaded");
+		return false;
+	}
+
+	ComboGraph compiledGraph;
+	if (!compiledGraph.CreateComboGraph(movesetTable, compileDiagnostics))
+	{
+		return false;
+	}
+
+	TArray<uint8> compiledImage;
+	TArray<FComboGraphMoveData> compiledMoveData;
+	compiledGraph.CopyImage(compiledImage);
+	compiledGraph.CopyMoveData(compiledMoveData);
+
+	// Compilation is deterministic, so an unchanged table gives the same image and the graphs already handed out stay valid
+	if (compiledImage == graphImage && IsSameMoveData(compiledMoveData, nodeMoveData))
+	{
+		return true;
+	}
+
+	// Graphs handed out by the cache use the stored image in place. New requests get a graph of the new image,
+	// and the previous image is kept alive for the graphs still using it.
+	ComboGraphCache::Invalidate(this);
+	if (graphImage.Num() > 0)
+	{
+		retiredGraphImages.Add(MoveTemp(graphImage));
+		retiredNodeMoveData.Add(MoveTemp(nodeMoveData));
+	}
+
+	graphImage = MoveTemp(compiledImage);
+	nodeMoveData = MoveTemp(compiledMoveData);
+	return true;
+}
+
+bool UComboMovesetAsset::VerifyAgainstSourceTable(FString& outError)
+{
+	UDataTable* movesetTable = sourceTable.LoadSynchronous();
+	if (movesetTable == nullptr)
+	{
+		outError = TEXT("Source table could not be loaded");
+		return false;
+	}
+
+	ComboGraph storedGraph;
+	if (!InitializeGraph(storedGraph))
+	{
+		outError = TEXT("The asset has no valid graph image");
+		return false;
+	}
+
+	ComboGraph compiledGraph;
+	if (!compiledGraph.CreateComboGraph(movesetTable))
+	{
+		outError = TEXT("Source table could not be compiled");
+		return false;
+	}
+
+	// Compilation is deterministic, so an up to date image is identical to a fresh one
+	TArray<uint8> compiledImage;
+	compiledGraph.CopyImage(compiledImage);
+	if (compiledImage != graphImage)
+	{
+		outError = TEXT("The graph image is out of date with the source table");
+		return false;
+	}
+
+	// The image only holds the chains, a renamed move or a new montage is only seen in the move data
+	TArray<FComboGraphMoveData> compiledMoveData;
+	compiledGraph.CopyMoveData(compiledMoveData);
+	if (!IsSameMoveData(compiledMoveData, nodeMoveData))
+	{
+		outError = TEXT("The move data is out of date with the source table");
+		return false;
+	}
+
+	// Every row that made it into the graph must be found through the stored image
+	for (int32 nodeIndex = 1; nodeIndex < compiledGraph.GetNodeCount(); nodeIndex++)
+	{
+		const FName rowName = compiledGraph.GetRowName(compiledGraph.GetNode(nodeIndex));
+		const FAttackAction_Struct* row = movesetTable->FindRow<FAttackAction_Struct>(rowName, TEXT(""));
+
+		FComboGraphCursor cursor;
+		const FComboGraphNode* foundNode = nullptr;
+		for (const uint8 input : row->GetRequiredInputs())
+		{
+			foundNode = storedGraph.AdvanceCursor(cursor, input);
+			if (foundNode == nullptr)
+			{
+				break;
+			}
+		}
+
+		if (foundNode == nullptr || storedGraph.GetRowName(foundNode) != rowName)
+		{
+			outError = TEXT("Row ") + rowName.ToString() + TEXT(" is not found through the graph image");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool UComboMovesetAsset::InitializeGraph(ComboGraph& outGraph) const
+{
+	return outGraph.InitializeFromImage(graphImage.GetData(), graphImage.Num(), nodeMoveData.GetData(), nodeMoveData.Num());
+}
+
+void UComboMovesetAsset::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	// Images written with another layout version are dropped on load, and the graph is compiled from the source table instead until the asset is saved again
+	uint32 imageVersion = ComboGraph::ImageVersion;
+	Ar << imageVersion;
+	graphImage.BulkSerialize(Ar);
+
+	if (Ar.IsLoading() && imageVersion != ComboGraph::ImageVersion)
+	{
+		graphImage.Empty();
+	}
+}
+
+#if WITH_EDITOR
+void UComboMovesetAsset::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+
+	// Always save and cook an image that matches the current source table. If the table cannot be compiled, the previous image is saved and the problems are kept in the diagnostics.
+	RebuildFromSourceTable();
+}
+#endif
@@ -0,0 +1,84 @@
+#include "ComboMovesetCookCommandlet.h"
+#include "ComboMovesetAsset.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#include "UObject/SavePackage.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogComboMovesetCook, Log, All);
+
+
+UComboMovesetCookCommandlet::UComboMovesetCookCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UComboMovesetCookCommandlet::Main(const FString& Params)
+{
+	const bool verifyOnly = FParse::Param(*Params, TEXT("verify"));
+
+	IAssetRegistry& assetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	assetRegistry.SearchAllAssets(true);
+
+	TArray<FAssetData> movesetAssets;
+	assetRegistry.GetAssetsByClass(UComboMovesetAsset::StaticClass()->GetClassPathName(), movesetAssets);
+
+	int32 failedMovesets = 0;
+
+	for (const FAssetData& movesetAssetData : movesetAssets)
+	{
+		UComboMovesetAsset* movesetAsset = Cast<UComboMovesetAsset>(movesetAssetData.GetAsset());
+		if (movesetAsset == nullptr)
+		{
+			UE_LOG(LogComboMovesetCook, Error, TEXT("%s: could not be loaded"), *movesetAssetData.GetObjectPathString());
+			failedMovesets++;
+			continue;
+		}
+
+		if (!verifyOnly)
+		{
+			const bool rebuilt = movesetAsset->RebuildFromSourceTable();
+
+			for (const FComboGraphDiagnostic& diagnostic : movesetAsset->compileDiagnostics)
+			{
+				UE_LOG(LogComboMovesetCook, Warning, TEXT("%s: row %s: %s"), *movesetAsset->GetPathName(), *diagnostic.rowName.ToString(), *diagnostic.message);
+			}
+
+			if (!rebuilt)
+			{
+				UE_LOG(LogComboMovesetCook, Error, TEXT("%s: source table could not be compiled"), *movesetAsset->GetPathName());
+				failedMovesets++;
+				continue;
+			}
+
+#if WITH_EDITOR
+			UPackage* movesetPackage = movesetAsset->GetPackage();
+			const FString packageFileName = FPackageName::LongPackageNameToFilename(movesetPackage->GetName(), FPackageName::GetAssetPackageExtension());
+
+			FSavePackageArgs saveArgs;
+			saveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+			if (!UPackage::SavePackage(movesetPackage, movesetAsset, *packageFileName, saveArgs))
+			{
+				UE_LOG(LogComboMovesetCook, Error, TEXT("%s: could not be saved"), *movesetAsset->GetPathName());
+				failedMovesets++;
+				continue;
+			}
+#endif
+		}
+
+		FString verifyError;
+		if (!movesetAsset->VerifyAgainstSourceTable(verifyError))
+		{
+			UE_LOG(LogComboMovesetCook, Error, TEXT("%s: %s"), *movesetAsset->GetPathName(), *verifyError);
+			failedMovesets++;
+			continue;
+		}
+
+		UE_LOG(LogComboMovesetCook, Display, TEXT("%s: %d nodes OK"), *movesetAsset->GetPathName(), movesetAsset->nodeMoveData.Num());
+	}
+
+	UE_LOG(LogComboMovesetCook, Display, TEXT("%d movesets processed, %d failed"), movesetAssets.Num(), failedMovesets);
+	return failedMovesets == 0 ? 0 : 1;
+}
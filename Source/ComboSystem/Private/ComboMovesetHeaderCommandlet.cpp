@@ -0,0 +1,207 @@
+#include "ComboMovesetHeaderCommandlet.h"
+#include "ComboGraph.h"
+#include "ComboGraphCompiler.h"
+#include "Engine/DataTable.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogComboMovesetHeader, Log, All);
+
+namespace
+{
+	// Number of values written on each line of the generated arrays
+	constexpr int32 ValuesPerLine = 16;
+
+	// Whether the name can be used as part of C++ identifiers
+	bool IsValidIdentifier(const FString& name)
+	{
+		if (name.IsEmpty() || FChar::IsDigit(name[0]))
+		{
+			return false;
+		}
+
+		for (const TCHAR character : name)
+		{
+			if (!FChar::IsAlnum(character) && character != TEXT('_'))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Writes a constexpr array of integers, a few values per line
+	template<typename TValue>
+	void WriteIntegerArray(FString& output, const TCHAR* declaration, TArrayView<const TValue> values)
+	{
+		output += FString::Printf(TEXT("\t%s[%d] =\n\t{"), declaration, values.Num());
+		for (int32 valueIndex = 0; valueIndex < values.Num(); valueIndex++)
+		{
+			output += valueIndex % ValuesPerLine == 0 ? TEXT("\n\t\t") : TEXT(" ");
+			output += FString::Printf(TEXT("%lld,"), int64(values[valueIndex]));
+		}
+		output += TEXT("\n\t};\n\n");
+	}
+
+	// Writes a constexpr array of string literals, one per line
+	void WriteStringArray(FString& output, const TCHAR* declaration, TArrayView<const FString> values)
+	{
+		output += FString::Printf(TEXT("\t%s[%d] =\n\t{\n"), declaration, values.Num());
+		for (const FString& value : values)
+		{
+			output += FString::Printf(TEXT("\t\tTEXT(\"%s\"),\n"), *value.ReplaceCharWithEscapedChar());
+		}
+		output += TEXT("\t};\n\n");
+	}
+}
+
+
+UComboMovesetHeaderCommandlet::UComboMovesetHeaderCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UComboMovesetHeaderCommandlet::Main(const FString& Params)
+{
+	FString tablePath;
+	FString movesetName;
+	FString outputPath;
+	if (!FParse::Value(*Params, TEXT("table="), tablePath) || !FParse::Value(*Params, TEXT("name="), movesetName) || !FParse::Value(*Params, TEXT("output="), outputPath))
+	{
+		UE_LOG(LogComboMovesetHeader, Error, TEXT("Usage: -run=ComboMovesetHeader -table=<moveset table path> -name=<moveset name> -output=<header file>"));
+		return 1;
+	}
+
+	if (!IsValidIdentifier(movesetName))
+	{
+		UE_LOG(LogComboMovesetHeader, Error, TEXT("%s is not a valid C++ identifier"), *movesetName);
+		return 1;
+	}
+
+	UDataTable* movesetTable = LoadObject<UDataTable>(nullptr, *tablePath);
+	if (movesetTable == nullptr)
+	{
+		UE_LOG(LogComboMovesetHeader, Error, TEXT("%s: could not be loaded"), *tablePath);
+		return 1;
+	}
+
+	ComboGraph graph;
+	TArray<FComboGraphDiagnostic> diagnostics;
+	if (!graph.CreateComboGraph(movesetTable, diagnostics))
+	{
+		UE_LOG(LogComboMovesetHeader, Error, TEXT("%s: could not be compiled"), *tablePath);
+		return 1;
+	}
+
+	for (const FComboGraphDiagnostic& diagnostic : diagnostics)
+	{
+		UE_LOG(LogComboMovesetHeader, Warning, TEXT("%s: row %s: %s"), *tablePath, *diagnostic.rowName.ToString(), *diagnostic.message);
+	}
+
+	const int32 nodeCount = graph.GetNodeCount();
+
+	// Next node for every node and input, found by asking the graph itself so the table cannot disagree with it
+	TArray<int32> nodeTransitions;
+	nodeTransitions.Init(INDEX_NONE, nodeCount * ComboGraph::MaxInputSymbols);
+	TBitArray<> usedInputs(false, ComboGraph::MaxInputSymbols);
+	for (int32 nodeIndex = 0; nodeIndex < nodeCount; nodeIndex++)
+	{
+		for (int32 input = 0; input < ComboGraph::MaxInputSymbols; input++)
+		{
+			FComboGraphCursor cursor;
+			cursor.nodeIndex = nodeIndex;
+			if (graph.AdvanceCursor(cursor, static_cast<uint8>(input)) != nullptr)
+			{
+				nodeTransitions[nodeIndex * ComboGraph::MaxInputSymbols + input] = cursor.nodeIndex;
+				usedInputs[input] = true;
+			}
+		}
+	}
+
+	// Inputs the moveset never uses all share column 0, so the table only grows with the inputs that are used
+	TArray<uint16> inputSymbols;
+	inputSymbols.Init(0, ComboGraph::MaxInputSymbols);
+	TArray<int32> symbolInputs;
+	symbolInputs.Add(INDEX_NONE);
+	for (int32 input = 0; input < ComboGraph::MaxInputSymbols; input++)
+	{
+		if (usedInputs[input])
+		{
+			inputSymbols[input] = static_cast<uint16>(symbolInputs.Add(input));
+		}
+	}
+
+	const int32 symbolCount = symbolInputs.Num();
+	TArray<int32> transitions;
+	transitions.Init(INDEX_NONE, nodeCount * symbolCount);
+	for (int32 nodeIndex = 0; nodeIndex < nodeCount; nodeIndex++)
+	{
+		for (int32 symbol = 1; symbol < symbolCount; symbol++)
+		{
+			transitions[nodeIndex * symbolCount + symbol] = nodeTransitions[nodeIndex * ComboGraph::MaxInputSymbols + symbolInputs[symbol]];
+		}
+	}
+
+	TArray<int32> parentIndices;
+	TArray<int32> depths;
+	TArray<int32> childCounts;
+	for (int32 nodeIndex = 0; nodeIndex < nodeCount; nodeIndex++)
+	{
+		const FComboGraphNode* node = graph.GetNode(nodeIndex);
+		parentIndices.Add(node->parentIndex);
+		depths.Add(node->depth);
+		childCounts.Add(node->childCount);
+	}
+
+	TArray<FComboGraphMoveData> moveData;
+	graph.CopyMoveData(moveData);
+	TArray<FString> rowNames;
+	TArray<FString> moveNames;
+	TArray<FString> attackAnimationPaths;
+	for (const FComboGraphMoveData& nodeMove : moveData)
+	{
+		rowNames.Add(nodeMove.rowName.IsNone() ? FString() : nodeMove.rowName.ToString());
+		moveNames.Add(nodeMove.moveName);
+		attackAnimationPaths.Add(nodeMove.attackAnimation.ToSoftObjectPath().ToString());
+	}
+
+	TArray<uint8> image;
+	graph.CopyImage(image);
+
+	const FString movesetStruct = FString::Printf(TEXT("FComboStaticMoveset_%s"), *movesetName);
+
+	FString output;
+	output += FString::Printf(TEXT("// Generated by the ComboMovesetHeader commandlet from %s. Do not edit, regenerate it whenever the table changes.\n"), *movesetTable->GetPathName());
+	output += FString::Printf(TEXT("// Include it in one source file of the game module to compile the %s moveset into the game.\n\n"), *movesetName);
+	output += TEXT("#pragma once\n\n#include \"ComboGraph.h\"\n#include \"ComboStaticMoveset.h\"\n\n");
+	output += FString::Printf(TEXT("static_assert(ComboGraph::ImageVersion == %u, \"The %s moveset was generated for another graph image layout, regenerate it\");\n\n"), ComboGraph::ImageVersion, *movesetName);
+	output += FString::Printf(TEXT("struct %s\n{\n"), *movesetStruct);
+	output += FString::Printf(TEXT("\tstatic constexpr const TCHAR* Name = TEXT(\"%s\");\n"), *movesetName);
+	output += FString::Printf(TEXT("\tstatic constexpr int32 NodeCount = %d;\n"), nodeCount);
+	output += FString::Printf(TEXT("\tstatic constexpr int32 SymbolCount = %d;\n"), symbolCount);
+	output += FString::Printf(TEXT("\tstatic constexpr int32 TreeDepth = %d;\n\n"), graph.GetTreeDepth());
+	WriteIntegerArray<uint16>(output, TEXT("static constexpr uint16 InputSymbols"), inputSymbols);
+	WriteIntegerArray<int32>(output, TEXT("static constexpr int32 Transitions"), transitions);
+	WriteIntegerArray<int32>(output, TEXT("static constexpr int32 ParentIndices"), parentIndices);
+	WriteIntegerArray<int32>(output, TEXT("static constexpr int32 Depths"), depths);
+	WriteIntegerArray<int32>(output, TEXT("static constexpr int32 ChildCounts"), childCounts);
+	WriteStringArray(output, TEXT("static constexpr const TCHAR* RowNames"), rowNames);
+	WriteStringArray(output, TEXT("static constexpr const TCHAR* MoveNames"), moveNames);
+	WriteStringArray(output, TEXT("static constexpr const TCHAR* AttackAnimationPaths"), attackAnimationPaths);
+	WriteIntegerArray<uint8>(output, TEXT("alignas(16) static constexpr uint8 Image"), image);
+	output.RemoveFromEnd(TEXT("\n"));
+	output += TEXT("};\n\n");
+	output += FString::Printf(TEXT("inline const TComboStaticMovesetRegistration<%s> GComboStaticMovesetRegistration_%s;\n"), *movesetStruct, *movesetName);
+
+	if (!FFileHelper::SaveStringToFile(output, *outputPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogComboMovesetHeader, Error, TEXT("%s: could not be written"), *outputPath);
+		return 1;
+	}
+
+	UE_LOG(LogComboMovesetHeader, Display, TEXT("%s: %d nodes, %d input columns written to %s"), *tablePath, nodeCount, symbolCount, *FPaths::ConvertRelativePathToFull(outputPath));
+	return 0;
+}
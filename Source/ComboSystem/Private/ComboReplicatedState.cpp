@@ -0,0 +1,43 @@
+#include "ComboReplicatedState.h"
+
+bool FComboReplicatedState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// Bits are read into zeroed values, since readers only overwrite the bits they are given
+	uint32 indexBits = Ar.IsLoading() ? 0 : nodeIndexBits;
+	uint32 nodeIndex = Ar.IsLoading() ? 0 : uint32(attackNodeIndex);
+	uint8 sequence = Ar.IsLoading() ? 0 : (inputSequence & InputSequenceMask);
+	uint8 ended = Ar.IsLoading() ? 0 : (comboEnded ? 1 : 0);
+	uint8 attacks = Ar.IsLoading() ? 0 : (attackCounter & AttackCounterMask);
+	uint8 moveSet = Ar.IsLoading() ? 0 : moveSetIndex;
+	uint8 switchedMoveSet = moveSet != 0 ? 1 : 0;
+
+	// The width goes first, so that a client can read the state even before it has compiled its own graph
+	Ar.SerializeBits(&indexBits, NodeIndexWidthBits);
+	if (indexBits > 0)
+	{
+		Ar.SerializeBits(&nodeIndex, indexBits);
+	}
+	Ar.SerializeBits(&ended, 1);
+	Ar.SerializeBits(&sequence, InputSequenceBits);
+	Ar.SerializeBits(&attacks, AttackCounterBits);
+
+	// Most components never switch moveset, so the index is only sent once it is not the first one
+	Ar.SerializeBits(&switchedMoveSet, 1);
+	if (switchedMoveSet != 0)
+	{
+		Ar << moveSet;
+	}
+
+	if (Ar.IsLoading())
+	{
+		nodeIndexBits = static_cast<uint8>(indexBits);
+		attackNodeIndex = static_cast<int32>(nodeIndex);
+		comboEnded = ended != 0;
+		inputSequence = sequence;
+		attackCounter = attacks;
+		moveSetIndex = moveSet;
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
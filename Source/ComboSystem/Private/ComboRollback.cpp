@@ -0,0 +1,141 @@
+#include "ComboRollback.h"
+#include "ComboMoveSetLibrary.h"
+
+namespace
+{
+	// Ends the combo in progress and starts the attack cooldown
+	void EndCombo(const FComboRollbackConfig& config, FComboRollbackState& state, EComboRollbackFrameFlags reason)
+	{
+		state.eventNodeIndex = state.nodeIndex;
+		state.nodeIndex = 0;
+		state.comboResetFrames = 0;
+		state.attackCooldownFrames = config.attackCooldownFrames;
+		state.frameFlags |= static_cast<uint8>(reason);
+	}
+
+	// Clears the flags of the previous frame and counts the timers down. Timers come before the input, so that an input on the frame a timer runs out sees the timer as over.
+	void CountDownTimers(const FComboRollbackConfig& config, FComboRollbackState& state)
+	{
+		state.frameFlags = static_cast<uint8>(EComboRollbackFrameFlags::None);
+		state.eventNodeIndex = 0;
+
+		if (state.attackCooldownFrames > 0)
+		{
+			state.attackCooldownFrames--;
+		}
+
+		if (state.comboResetFrames > 0)
+		{
+			state.comboResetFrames--;
+			if (state.comboResetFrames == 0 && state.nodeIndex != 0)
+			{
+				EndCombo(config, state, EComboRollbackFrameFlags::ComboTimedOut);
+			}
+		}
+	}
+
+	// Performs the attack input of the frame, if any, on the given graph
+	void ApplyAttackInput(const ComboGraph& graph, const FComboRollbackConfig& config, FComboRollbackState& state, int32 input)
+	{
+		if (input == ComboRollback::NoInput)
+		{
+			return;
+		}
+
+		if (state.attackCooldownFrames > 0)
+		{
+			state.frameFlags |= static_cast<uint8>(EComboRollbackFrameFlags::InputIgnored);
+			return;
+		}
+
+		FComboGraphCursor cursor;
+		cursor.nodeIndex = state.nodeIndex;
+		const FComboGraphNode* attackToPerform = graph.AdvanceCursor(cursor, static_cast<uint8>(input), config.missPolicy);
+
+		// The input does not lead to any attack
+		if (attackToPerform == nullptr)
+		{
+			EndCombo(config, state, EComboRollbackFrameFlags::ComboBroken);
+			return;
+		}
+
+		state.nodeIndex = cursor.nodeIndex;
+		state.frameFlags |= static_cast<uint8>(EComboRollbackFrameFlags::AttackPerformed);
+
+		// The last attack of a chain ends the combo right away
+		if (attackToPerform->childCount < 1)
+		{
+			EndCombo(config, state, EComboRollbackFrameFlags::ComboCompleted);
+			return;
+		}
+
+		state.eventNodeIndex = cursor.nodeIndex;
+		state.comboResetFrames = config.comboResetFrames;
+	}
+
+	// Moves the state to another moveset of the library. Indices out of range and the moveset already in use are ignored.
+	void SwitchMoveSet(const ComboMoveSetLibrary& library, const FComboRollbackConfig& config, FComboRollbackState& state, int32 moveSetIndex)
+	{
+		if (moveSetIndex == state.moveSetIndex || moveSetIndex >= library.GetNumMoveSets() || moveSetIndex > MAX_uint8)
+		{
+			return;
+		}
+
+		// A chain the new moveset does not have is broken like a missed input, leaving the event node on the moveset switched from
+		const int32 mappedNodeIndex = library.MapCursor(state.moveSetIndex, moveSetIndex, state.nodeIndex, config.missPolicy);
+		if (state.nodeIndex != 0 && mappedNodeIndex == 0)
+		{
+			EndCombo(config, state, EComboRollbackFrameFlags::ComboBroken);
+		}
+		state.nodeIndex = mappedNodeIndex;
+		state.moveSetIndex = static_cast<uint8>(moveSetIndex);
+		state.frameFlags |= static_cast<uint8>(EComboRollbackFrameFlags::MoveSetSwitched);
+	}
+}
+
+
+void ComboRollback::SimulateFrame(const ComboGraph& graph, const FComboRollbackConfig& config, FComboRollbackState& state, int32 input)
+{
+	CountDownTimers(config, state);
+
+	if (IsSwitchMoveSetInput(input) == false)
+	{
+		ApplyAttackInput(graph, config, state, input);
+	}
+}
+
+void ComboRollback::SimulateFrame(const ComboMoveSetLibrary& library, const FComboRollbackConfig& config, FComboRollbackState& state, int32 input)
+{
+	CountDownTimers(config, state);
+
+	if (IsSwitchMoveSetInput(input))
+	{
+		SwitchMoveSet(library, config, state, input - SwitchMoveSetInputBase);
+	}
+	else if (const ComboGraph* graph = library.FindGraph(state.moveSetIndex))
+	{
+		ApplyAttackInput(*graph, config, state, input);
+	}
+}
+
+void ComboRollback::Resimulate(const ComboGraph& graph, const FComboRollbackConfig& config, FComboRollbackState& state, TArrayView<const int32> frameInputs)
+{
+	for (const int32 input : frameInputs)
+	{
+		SimulateFrame(graph, config, state, input);
+	}
+}
+
+void ComboRollback::Resimulate(const ComboMoveSetLibrary& library, const FComboRollbackConfig& config, FComboRollbackState& state, TArrayView<const int32> frameInputs)
+{
+	for (const int32 input : frameInputs)
+	{
+		SimulateFrame(library, config, state, input);
+	}
+}
+
+uint16 ComboRollback::SecondsToFrames(float seconds, int32 frameRate)
+{
+	const int64 frames = FMath::CeilToInt64(double(FMath::Max(seconds, 0.0f)) * FMath::Max(frameRate, 1));
+	return static_cast<uint16>(FMath::Min<int64>(frames, MAX_uint16));
+}
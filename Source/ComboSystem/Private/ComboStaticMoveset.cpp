@@ -0,0 +1,32 @@
+#include "ComboStaticMoveset.h"
+
+
+TArray<const FComboStaticMovesetTable*>& ComboStaticMovesetRegistry::GetRegisteredMovesets()
+{
+	static TArray<const FComboStaticMovesetTable*> registeredMovesets;
+	return registeredMovesets;
+}
+
+void ComboStaticMovesetRegistry::Register(const FComboStaticMovesetTable* staticMoveset)
+{
+	check(staticMoveset != nullptr && staticMoveset->name != nullptr);
+
+	GetRegisteredMovesets().AddUnique(staticMoveset);
+}
+
+const FComboStaticMovesetTable* ComboStaticMovesetRegistry::Find(FName movesetName)
+{
+	if (movesetName.IsNone())
+	{
+		return nullptr;
+	}
+
+	for (const FComboStaticMovesetTable* staticMoveset : GetRegisteredMovesets())
+	{
+		if (FName(staticMoveset->name) == movesetName)
+		{
+			return staticMoveset;
+		}
+	}
+	return nullptr;
+}
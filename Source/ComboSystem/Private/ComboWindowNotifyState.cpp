@@ -0,0 +1,57 @@
+#include "ComboWindowNotifyState.h"
+#include "ComboComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Animation/AnimSequenceBase.h"
+
+namespace
+{
+	// The combo component of the actor owning the mesh. Null for preview meshes in the editor, which have no combo component.
+	UComboComponent* FindComboComponent(const USkeletalMeshComponent* meshComponent)
+	{
+		const AActor* owner = meshComponent != nullptr ? meshComponent->GetOwner() : nullptr;
+		return owner != nullptr ? owner->FindComponentByClass<UComboComponent>() : nullptr;
+	}
+}
+
+
+bool UComboWindowNotifyState::HasComboWindows(const UAnimSequenceBase* animation)
+{
+	if (animation == nullptr)
+	{
+		return false;
+	}
+
+	for (const FAnimNotifyEvent& notifyEvent : animation->Notifies)
+	{
+		if (Cast<UComboWindowNotifyState>(notifyEvent.NotifyStateClass) != nullptr)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void UComboWindowNotifyState::NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration, const FAnimNotifyEventReference& EventReference)
+{
+	Super::NotifyBegin(MeshComp, Animation, TotalDuration, EventReference);
+
+	if (UComboComponent* comboComponent = FindComboComponent(MeshComp))
+	{
+		comboComponent->OpenComboWindow(windowType, Animation);
+	}
+}
+
+void UComboWindowNotifyState::NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference)
+{
+	if (UComboComponent* comboComponent = FindComboComponent(MeshComp))
+	{
+		comboComponent->CloseComboWindow(windowType, Animation);
+	}
+
+	Super::NotifyEnd(MeshComp, Animation, EventReference);
+}
+
+FString UComboWindowNotifyState::GetNotifyName_Implementation() const
+{
+	return windowType == EComboWindowType::AcceptInput ? TEXT("Combo Accept Input") : TEXT("Combo Cancel");
+}
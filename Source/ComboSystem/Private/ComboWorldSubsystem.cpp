@@ -0,0 +1,420 @@
+#include "ComboWorldSubsystem.h"
+#include "ComboComponent.h"
+#include "ComboMetrics.h"
+#include "Async/ParallelFor.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogComboEvents, Log, All);
+DEFINE_LOG_CATEGORY_STATIC(LogComboInputRecording, Log, All);
+
+// Batches smaller than this are resolved on the game thread, since handing them to workers costs more than resolving them
+static constexpr int32 MinParallelAttackInputBatchSize = 64;
+
+static FAutoConsoleCommandWithWorldAndArgs DumpComboEventsCommand(
+	TEXT("combo.DumpEvents"),
+	TEXT("Writes the recent combo events of the world to a file, which the ComboEventDump commandlet turns into per-actor timelines. Usage: combo.DumpEvents [FileName]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& args, UWorld* world)
+	{
+		UComboWorldSubsystem* comboSubsystem = world != nullptr ? world->GetSubsystem<UComboWorldSubsystem>() : nullptr;
+		if (comboSubsystem != nullptr)
+		{
+			comboSubsystem->DumpEvents(args.Num() > 0 ? args[0] : FString());
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs RecordComboInputsCommand(
+	TEXT("combo.RecordInputs"),
+	TEXT("Starts recording every attack input of the world, or stops the recording in progress and writes it to a file that the ComboInputReplay commandlet replays headless. Usage: combo.RecordInputs [FileName]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& args, UWorld* world)
+	{
+		UComboWorldSubsystem* comboSubsystem = world != nullptr ? world->GetSubsystem<UComboWorldSubsystem>() : nullptr;
+		if (comboSubsystem == nullptr)
+		{
+			return;
+		}
+
+		if (comboSubsystem->IsRecordingInputs())
+		{
+			comboSubsystem->StopInputRecording(args.Num() > 0 ? args[0] : FString());
+		}
+		else
+		{
+			comboSubsystem->StartInputRecording();
+		}
+	}));
+
+
+void UComboWorldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	systemErrorHandle = FCoreDelegates::OnHandleSystemError.AddUObject(this, &UComboWorldSubsystem::DumpEventsOnSystemError);
+}
+
+void UComboWorldSubsystem::Deinitialize()
+{
+	FCoreDelegates::OnHandleSystemError.Remove(systemErrorHandle);
+
+	Super::Deinitialize();
+}
+
+
+int32 UComboWorldSubsystem::RegisterComponent(UComboComponent* component)
+{
+	const int32 slot = slotComponents.Add(component);
+	comboResetDeadline.Add(0.0);
+	attackCooldownDeadline.Add(0.0);
+	canAttack.Add(true);
+
+	const AActor* owner = component->GetOwner();
+	eventRecorder.RegisterComponentName(component->GetUniqueID(), owner != nullptr ? owner->GetFName() : component->GetFName());
+
+	if (component->bufferAttackInputs)
+	{
+		inputBufferComponents.Add(component);
+	}
+	return slot;
+}
+
+void UComboWorldSubsystem::UnregisterComponent(int32 slot)
+{
+	check(slotComponents.IsValidIndex(slot));
+
+	inputBufferComponents.RemoveSingleSwap(slotComponents[slot], false);
+
+	// Any deadline still in the heap for this component is skipped once the component no longer has a slot
+	slotComponents.RemoveAtSwap(slot, 1, false);
+	comboResetDeadline.RemoveAtSwap(slot, 1, false);
+	attackCooldownDeadline.RemoveAtSwap(slot, 1, false);
+	canAttack.RemoveAtSwap(slot, 1, false);
+
+	// The last slot has been moved into the freed one
+	if (slotComponents.IsValidIndex(slot))
+	{
+		slotComponents[slot]->comboSlot = slot;
+	}
+}
+
+void UComboWorldSubsystem::NotifyAttackInput(int32 slot, float comboResetTime)
+{
+	const double expiryTime = GetCurrentTime() + comboResetTime;
+	comboResetDeadline[slot] = expiryTime;
+	ScheduleDeadline(slot, EComboDeadlineType::ComboReset, expiryTime);
+}
+
+void UComboWorldSubsystem::StartAttackCooldown(int32 slot, float cooldownTime)
+{
+	// There is no combo left to reset while the cooldown is active
+	comboResetDeadline[slot] = 0.0;
+
+	const double expiryTime = GetCurrentTime() + cooldownTime;
+	canAttack[slot] = false;
+	attackCooldownDeadline[slot] = expiryTime;
+	ScheduleDeadline(slot, EComboDeadlineType::AttackCooldownEnd, expiryTime);
+
+	RecordEvent(EComboTraceEventType::CooldownStarted, slotComponents[slot]);
+}
+
+void UComboWorldSubsystem::RecordEvent(EComboTraceEventType type, const UComboComponent* component, int32 nodeIndex, int32 depth, uint8 payload)
+{
+	FComboTraceEvent event;
+	event.time = GetCurrentTime();
+	event.componentId = component->GetUniqueID();
+	event.nodeIndex = nodeIndex;
+	event.depth = static_cast<uint16>(depth);
+	event.type = type;
+	event.payload = payload;
+	eventRecorder.Record(event);
+}
+
+bool UComboWorldSubsystem::DumpEvents(const FString& fileName) const
+{
+	const FString dumpFileName = !fileName.IsEmpty() ? fileName
+		: FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ComboEvents"), FString::Printf(TEXT("%s-%s.cmbt"), *GetWorld()->GetMapName(), *FDateTime::Now().ToString()));
+
+	if (!eventRecorder.WriteToFile(dumpFileName))
+	{
+		UE_LOG(LogComboEvents, Error, TEXT("Combo events could not be written to %s"), *dumpFileName);
+		return false;
+	}
+
+	UE_LOG(LogComboEvents, Display, TEXT("Combo events written to %s"), *dumpFileName);
+	return true;
+}
+
+void UComboWorldSubsystem::StartInputRecording()
+{
+	inputRecording = MakeUnique<ComboInputRecording>();
+	inputRecordingStartTime = GetCurrentTime();
+	inputRecordingStartFrame = GFrameCounter;
+
+	// A recording can start mid-combo, so the replay needs to know where every component was and which timers it was waiting for
+	for (int32 slot = 0; slot < slotComponents.Num(); slot++)
+	{
+		FComboRecordedStartState startState;
+		startState.nodeIndex = slotComponents[slot]->GetComboNodeIndex();
+		startState.moveSetIndex = static_cast<uint8>(slotComponents[slot]->GetActiveMoveSetIndex());
+		startState.comboResetDelay = comboResetDeadline[slot] > 0.0 ? static_cast<float>(FMath::Max(comboResetDeadline[slot] - inputRecordingStartTime, 0.0)) : 0.0f;
+		startState.attackCooldownDelay = canAttack[slot] == false ? static_cast<float>(FMath::Max(attackCooldownDeadline[slot] - inputRecordingStartTime, 0.0)) : 0.0f;
+		inputRecording->SetStartState(slotComponents[slot], startState);
+	}
+
+	UE_LOG(LogComboInputRecording, Display, TEXT("Recording attack inputs"));
+}
+
+bool UComboWorldSubsystem::StopInputRecording(const FString& fileName)
+{
+	if (!inputRecording.IsValid())
+	{
+		return false;
+	}
+
+	TUniquePtr<ComboInputRecording> stoppedRecording = MoveTemp(inputRecording);
+	stoppedRecording->duration = GetCurrentTime() - inputRecordingStartTime;
+	stoppedRecording->frameCount = static_cast<uint32>(FMath::Min<uint64>(GFrameCounter - inputRecordingStartFrame, MAX_uint32));
+
+	const FString recordingFileName = !fileName.IsEmpty() ? fileName
+		: FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ComboInputs"), FString::Printf(TEXT("%s-%s.cmbi"), *GetWorld()->GetMapName(), *FDateTime::Now().ToString()));
+
+	if (!stoppedRecording->WriteToFile(recordingFileName))
+	{
+		UE_LOG(LogComboInputRecording, Error, TEXT("Attack inputs could not be written to %s"), *recordingFileName);
+		return false;
+	}
+
+	UE_LOG(LogComboInputRecording, Display, TEXT("%d attack inputs of %d actors written to %s"), stoppedRecording->inputs.Num(), stoppedRecording->actors.Num(), *recordingFileName);
+	return true;
+}
+
+void UComboWorldSubsystem::RestoreRecordedStartState(UComboComponent* component, const FComboRecordedStartState& startState)
+{
+	if (component == nullptr || component->comboSlot == INDEX_NONE)
+	{
+		return;
+	}
+
+	// The node index belongs to the graph of the moveset the component was using
+	if ((component->moveSetGraph.IsValid() || component->AcquireMoveSetGraph()) && component->moveSetLibrary.IsValid()
+		&& startState.moveSetIndex != component->activeMoveSetIndex && startState.moveSetIndex < component->moveSetLibrary->GetNumMoveSets())
+	{
+		component->SetActiveMoveSet(startState.moveSetIndex);
+	}
+
+	if (component->moveSetGraph.IsValid() && component->moveSetGraph->GetNode(startState.nodeIndex) != nullptr)
+	{
+		component->comboCursor.nodeIndex = startState.nodeIndex;
+		component->UpdateMontagePrefetch();
+	}
+
+	// The cooldown starts when a combo is reset, so the two are never pending at once
+	if (startState.attackCooldownDelay > 0.0f)
+	{
+		StartAttackCooldown(component->comboSlot, startState.attackCooldownDelay);
+	}
+	else if (startState.comboResetDelay > 0.0f && component->comboCursor.IsAtRoot() == false)
+	{
+		NotifyAttackInput(component->comboSlot, startState.comboResetDelay);
+	}
+}
+
+void UComboWorldSubsystem::DumpEventsOnSystemError()
+{
+	DumpEvents(FString());
+}
+
+void UComboWorldSubsystem::ProcessAttackInputBatch(TArrayView<const FComboAttackInputRequest> requests)
+{
+	check(IsInGameThread());
+
+	// A listener broadcast to during the commit phase is sending more inputs. Resolving them now would overwrite the scratch space the commit is walking.
+	if (processingAttackInputBatch)
+	{
+		deferredBatchRequests.Append(requests.GetData(), requests.Num());
+		return;
+	}
+
+	TGuardValue<bool> processingGuard(processingAttackInputBatch, true);
+	ResolveAttackInputBatch(requests);
+
+	// Batches started during the commit run in the order they were started, and may start more batches themselves
+	while (deferredBatchRequests.Num() > 0)
+	{
+		Swap(deferredBatchRequests, runningBatchRequests);
+		deferredBatchRequests.Reset();
+		ResolveAttackInputBatch(runningBatchRequests);
+	}
+	runningBatchRequests.Reset();
+}
+
+void UComboWorldSubsystem::ResolveAttackInputBatch(TArrayView<const FComboAttackInputRequest> requests)
+{
+	const int32 requestCount = requests.Num();
+	const double batchTimestamp = FPlatformTime::Seconds();
+	resolvedBatchInputs.Reset();
+	resolvedBatchInputs.SetNum(requestCount, false);
+
+	// Prepare phase: checks that may touch the graph cache or show debug messages stay on the game thread
+	for (int32 requestIndex = 0; requestIndex < requestCount; requestIndex++)
+	{
+		UComboComponent* component = requests[requestIndex].component;
+		FComboResolvedInput& resolvedInput = resolvedBatchInputs[requestIndex];
+
+		// Later inputs of a component already in the batch need to see the effects of the earlier ones.
+		// Only components whose combo is resolved locally take part in the parallel phase: autonomous proxies predict and send their inputs to the server, and simulated proxies ignore them.
+		if (component == nullptr || component->batchRequestIndex != INDEX_NONE || component->GetOwnerRole() == ROLE_AutonomousProxy || component->GetOwnerRole() == ROLE_SimulatedProxy)
+		{
+			resolvedInput.deferred = component != nullptr;
+			continue;
+		}
+
+		if (component->PrepareAttackInput(requests[requestIndex].attackType) == false)
+		{
+			continue;
+		}
+
+		component->batchRequestIndex = requestIndex;
+		resolvedInput.graph = component->moveSetGraph.Get();
+		resolvedInput.cursor = component->comboCursor;
+		resolvedInput.missPolicy = component->GetMissPolicy();
+	}
+
+	// Resolve phase: the graphs are immutable and each request only touches its own cursor copy, so this runs on any thread
+	{
+		COMBO_PHASE_SCOPE(AttackLookup);
+		ParallelFor(TEXT("ComboAttackInputBatch"), requestCount, MinParallelAttackInputBatchSize, [this, requests](int32 requestIndex)
+		{
+			FComboResolvedInput& resolvedInput = resolvedBatchInputs[requestIndex];
+			if (resolvedInput.graph != nullptr)
+			{
+				resolvedInput.attackToPerform = resolvedInput.graph->AdvanceCursor(resolvedInput.cursor, requests[requestIndex].attackType, resolvedInput.missPolicy);
+			}
+		}, requestCount < MinParallelAttackInputBatchSize ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	}
+
+	// Commit phase: side effects are applied in request order on the game thread
+	for (int32 requestIndex = 0; requestIndex < requestCount; requestIndex++)
+	{
+		UComboComponent* component = requests[requestIndex].component;
+		const FComboResolvedInput& resolvedInput = resolvedBatchInputs[requestIndex];
+
+		if (resolvedInput.deferred)
+		{
+			component->AttackInput(requests[requestIndex].attackType);
+		}
+		else if (component != nullptr)
+		{
+			if (resolvedInput.graph != nullptr)
+			{
+				component->batchRequestIndex = INDEX_NONE;
+				component->CommitAttackInput(resolvedInput.attackToPerform, resolvedInput.cursor, batchTimestamp);
+			}
+
+			// Deferred requests are recorded by AttackInput, the others once committed, whether or not they were accepted
+			RecordAttackInput(component, static_cast<uint8>(requests[requestIndex].attackType));
+		}
+	}
+}
+
+void UComboWorldSubsystem::ScheduleDeadline(int32 slot, EComboDeadlineType type, double expiryTime)
+{
+	FComboDeadline deadline;
+	deadline.expiryTime = expiryTime;
+	deadline.component = slotComponents[slot];
+	deadline.type = type;
+	deadlineHeap.HeapPush(deadline);
+}
+
+double UComboWorldSubsystem::GetSlotDeadline(int32 slot, EComboDeadlineType type) const
+{
+	return type == EComboDeadlineType::ComboReset ? comboResetDeadline[slot] : attackCooldownDeadline[slot];
+}
+
+double UComboWorldSubsystem::GetCurrentTime() const
+{
+	return GetWorld()->GetTimeSeconds();
+}
+
+double UComboWorldSubsystem::GetPreviousFrameTime() const
+{
+	return GetWorld()->GetTimeSeconds() - GetWorld()->GetDeltaSeconds();
+}
+
+bool UComboWorldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	// Components own no timers of their own, so without a subsystem they could never attack. Only the edited level itself, where nothing begins play, is left out.
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE || WorldType == EWorldType::GamePreview || WorldType == EWorldType::GameRPC || WorldType == EWorldType::EditorPreview;
+}
+
+bool UComboWorldSubsystem::IsTickable() const
+{
+	// Nothing can expire while the heap is empty, but buffered inputs have to be checked every frame
+	return deadlineHeap.Num() > 0 || inputBufferComponents.Num() > 0;
+}
+
+void UComboWorldSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double currentTime = GetCurrentTime();
+
+	while (deadlineHeap.Num() > 0 && deadlineHeap.HeapTop().expiryTime <= currentTime)
+	{
+		FComboDeadline deadline;
+		deadlineHeap.HeapPop(deadline, false);
+
+		// Skip deadlines of components that have gone away, and deadlines that have since been moved or cancelled
+		UComboComponent* component = deadline.component.Get();
+		if (component == nullptr || component->comboSlot == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const int32 slot = component->comboSlot;
+		if (GetSlotDeadline(slot, deadline.type) != deadline.expiryTime)
+		{
+			continue;
+		}
+
+		if (deadline.type == EComboDeadlineType::AttackCooldownEnd)
+		{
+			canAttack[slot] = true;
+			attackCooldownDeadline[slot] = 0.0;
+			RecordEvent(EComboTraceEventType::CooldownEnded, component);
+
+#if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
+			// Debugging messages
+			if (GEngine && ComboMetrics::ShowDebugMessages())
+			{
+				GEngine->AddOnScreenDebugMessage(1, 1.0f, FColor::Yellow, TEXT("Attack recovery cooldown timer has completed"));
+			}
+#endif
+		}
+		else
+		{
+			// The player took too long to perform the next attack in the chain
+			comboResetDeadline[slot] = 0.0;
+			component->OnComboResetDeadlineExpired();
+		}
+	}
+
+	// Drain the input buffers after the deadlines, so that an input waiting for the cooldown is performed on the frame the cooldown ends.
+	// Delegates fired while draining can unregister components, which moves the last one into the freed place, so the drain goes over a copy of the list.
+	drainingInputBufferComponents.Reset();
+	drainingInputBufferComponents.Append(inputBufferComponents);
+	for (UComboComponent* component : drainingInputBufferComponents)
+	{
+		// Skip components unregistered by an earlier drain this frame
+		if (IsValid(component) && component->comboSlot != INDEX_NONE)
+		{
+			component->DrainInputBuffer();
+		}
+	}
+}
+
+TStatId UComboWorldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UComboWorldSubsystem, STATGROUP_Tickables);
+}
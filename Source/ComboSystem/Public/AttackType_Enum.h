@@ -1,5 +1,7 @@
 /**
  * This enum defines the different types of attacks a player can perform.
+ * Combo graphs treat inputs as byte symbols, and these are symbols 0 to 2. Games with a larger input alphabet (directions, stances, button chords, context inputs)
+ * author their chains as symbols in FAttackAction_Struct::requiredInputSymbols and send them with UComboComponent::AttackInputSymbol.
  */
 UENUM(BlueprintType)
 enum AttackType_Enum: uint8
@@ -1,9 +1,50 @@
 #pragma once
 
 #include "Components/ActorComponent.h"
-#include "ComboGraph.h"
+#include "Containers/CircularQueue.h"
+#include "ComboGraphCache.h"
+#include "ComboMovesetAsset.h"
+#include "ComboEventRecorder.h"
+#include "ComboWindowNotifyState.h"
+#include "ComboRollback.h"
+#include "ComboReplicatedState.h"
 #include "ComboComponent.generated.h"
 
+class UComboWorldSubsystem;
+class UAnimInstance;
+class USkeletalMeshComponent;
+struct FStreamableHandle;
+
+/// <summary>
+/// An attack input waiting in the input buffer of a combo component.
+/// </summary>
+struct FComboBufferedAttackInput
+{
+	// Platform time at which the input was received, in seconds. Kept at sub-frame precision.
+	double timestamp = 0.0;
+
+	// The type of attack that was input
+	AttackType_Enum attackType = LightAttack;
+};
+
+/// <summary>
+/// An attack input a client has predicted and sent to the server, waiting for the server to resolve it.
+/// </summary>
+struct FComboPredictedInput
+{
+	// Sequence number the input was sent with
+	uint8 inputSequence = 0;
+
+	// The attack that was input
+	uint8 attackInput = 0;
+
+	// Whether the client took the input when it predicted it. Inputs the client ignored are not replayed on top of the server's state.
+	bool accepted = false;
+
+	// Whether the client queued the attack to perform it once the cancel window opens, rather than performing it right away. Queued inputs do not move the cursor when replayed.
+	bool queued = false;
+};
+
 /// <summary>
 /// This class contains the logic for the combo component which takes inputs based on move type and performs attack animations for the given movesets.
 /// The movesets are specified in a DataTable with rows based on ActionType_Struct.
@@ -14,6 +55,9 @@ class COMBOSYSTEM_API UComboComponent : public UActorComponent
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE(FComboBrokenDelegate);
 	GENERATED_BODY()
 
+	// The subsystem owns the timers of the component, updates its slot index when slots are moved around, fires its deadlines, and resolves its inputs in batches
+	friend class UComboWorldSubsystem;
+
 // Public variables and properties
 public:	
 
@@ -28,9 +72,36 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	UDataTable* moveSet;
 
+	/// <summary>
+	/// Optional cooked version of the moveset. When assigned, the combo graph is loaded from this asset instead of being compiled from the moveset table.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UComboMovesetAsset* compiledMoveSet;
+
+	/// <summary>
+	/// Optional name of a moveset compiled into the game with the ComboMovesetHeader commandlet. When it names a registered moveset,
+	/// it is used instead of the cooked moveset and the moveset table, and every attack input costs a single table index.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName staticMoveSet;
+
+	/// <summary>
+	/// Optional movesets the actor switches between with SwitchMoveSet, such as one per weapon or stance. When assigned, the first one is used to begin with
+	/// and every other moveset property is ignored. The tables are compiled together, so that movesets with the same button layout share their graph image, every move is stored once and a switch costs two lookups.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<UDataTable*> switchableMoveSets;
+
+	/// <summary>
+	/// What happens when an input does not continue the current chain, when the moveset comes from the moveset table or is compiled into the game.
+	/// Cooked movesets carry their own policy, which is used instead.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EComboMissPolicy missPolicy = EComboMissPolicy::ResetWithCooldown;
+
 	/// <summary>
 	/// How much time to allow before resetting the current combo sequence due to lack of attack inputs.
-	/// Default value is 1 second.
+	/// Default value is 1 second. Not used by attacks whose montage has combo windows.
 	/// </summary>
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float timeBeforeComboReset = 1.0f;
@@ -46,32 +117,167 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float attackRecoveryCooldown = 2.0f;
 
-	// Status of whether or not an actor can perform an attack this frame.
-	bool canAttack = true;
+	/// <summary>
+	/// How many inputs beyond the next one to stream attack montages in for. The montages of the attacks that can follow the current one are always streamed in,
+	/// and each extra level of lookahead also streams in the montages of the attacks after those.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	int32 montagePrefetchLookahead = 1;
+
+	/// <summary>
+	/// Whether attack inputs can be buffered with BufferAttackInput. Buffered inputs are drained once per frame by the combo subsystem,
+	/// and inputs received while the actor cannot attack wait in the buffer instead of being dropped.
+	/// Read when the component begins play.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	bool bufferAttackInputs = false;
+
+	/// <summary>
+	/// How long a buffered input stays valid, in seconds. Inputs still waiting for the attack cooldown to end after this long are dropped.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float inputBufferWindow = 0.2f;
+
+	/// <summary>
+	/// Whether the component is simulated at a fixed step, for rollback netcode. Attack inputs are then passed to SimulateFrame once per simulated frame instead of to AttackInput,
+	/// the combo timers are counted in frames, and the whole combo state can be saved, restored and resimulated. Combo windows from montage notifies are not used in this mode,
+	/// since they depend on animation playback, which is not resimulated.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	bool fixedStepSimulation = false;
+
+	/// <summary>
+	/// Number of frames simulated per second in fixed-step mode. Used to turn the combo timers into frame counts.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "1", EditCondition = "fixedStepSimulation"))
+	int32 fixedStepFrameRate = 60;
+
+	/// <summary>
+	/// Number of inputs the input buffer can hold. Inputs received while the buffer is full are dropped.
+	/// </summary>
+	static constexpr uint32 InputBufferCapacity = 32;
+
+	/// <summary>
+	/// Number of predicted inputs a client keeps while waiting for the server. Kept under half the sequence range, so that sequence numbers can be compared across wrap-around.
+	/// </summary>
+	static constexpr int32 MaxPendingPredictedInputs = 16;
 
 // Private variables and properties
 private:
-	// Stores how much time has passed since the last attack input was received.
-	float timeSinceLastAttackInput = 0.0f;
+	// The subsystem that owns the combo timers and flags of this component, updating them for every component in one pass each frame.
+	UPROPERTY(Transient)
+	UComboWorldSubsystem* comboSubsystem = nullptr;
+
+	// Slot of this component's combo state in the subsystem. INDEX_NONE while the component is not registered.
+	int32 comboSlot = INDEX_NONE;
+
+	// Index of the request resolving this component's input in the batch being processed by the subsystem. INDEX_NONE outside of a batch.
+	int32 batchRequestIndex = INDEX_NONE;
+
+	// Position of the actor in the combo graph. Moves one edge per attack input instead of storing the whole sequence performed so far.
+	FComboGraphCursor comboCursor;
+
+	// The combo graph for the moveset specified in the moveset table. Shared with every other component using the same table.
+	FComboGraphHandle moveSetGraph;
+
+	// The switchable movesets compiled together, when the component has any. Shared with every other component switching between the same tables.
+	FComboMoveSetLibraryHandle moveSetLibrary;
+
+	// Index in the switchable movesets of the one the graph comes from
+	int32 activeMoveSetIndex = 0;
+
+	// Lock-free single producer, single consumer queue of buffered inputs. Filled by one input thread, drained by the game thread.
+	TCircularQueue<FComboBufferedAttackInput> inputBuffer{ InputBufferCapacity };
+
+	// Platform time at which the last accepted attack input was received
+	double lastAttackInputTimestamp = 0.0;
 
+	// Load request of the montage of an attack performed before its prefetch finished. The montage is played as soon as it arrives.
+	TSharedPtr<FStreamableHandle> pendingAttackAnimationHandle;
 
-	// Stores how long it has been since the attack cooldown was activated
-	float attackRecoveryCooldownTimer = 0.0f;
+	// Node of the attack waiting for its montage to load. INDEX_NONE if none.
+	int32 pendingAttackAnimationNodeIndex = INDEX_NONE;
 
-	// Array to store the current sequence of attack types that the actor is performing.
-	TArray<TEnumAsByte<AttackType_Enum>> currentComboSequence;
+	// Keeps the montages of the attacks reachable from the current node loaded. Released once the montages are no longer reachable.
+	TSharedPtr<FStreamableHandle> montagePrefetchHandle;
 
-	// The combo graph for the moveset specified in the moveset table
-	ComboGraph moveSetGraph;
+	// The node the montages are currently streamed in for. INDEX_NONE if nothing is streamed in.
+	int32 montagePrefetchNodeIndex = INDEX_NONE;
 
-	FComboGraphNode* lastPerformedAttack = nullptr;
+	// The montages the prefetch handle was requested for
+	TArray<FSoftObjectPath> requestedMontagePaths;
 
+	// Scratch space for gathering the montages reachable from the current node, reused by every input
+	TArray<int32> prefetchReachableNodeIndices;
+	TArray<FSoftObjectPath> prefetchMontagePaths;
+
+	// Anim instances the attack montages are played on, with the montage delegates already bound. Rebuilt only when the owner's meshes change.
+	TArray<TWeakObjectPtr<UAnimInstance>> animationTargets;
+
+	// Skeletal meshes of the owner, watched so that the animation targets are rebuilt when one of them re-initializes its anim instance
+	TArray<TWeakObjectPtr<USkeletalMeshComponent>> animationTargetMeshes;
+
+	// Number of components the owner had when the animation targets were gathered. A different count means meshes may have been added or removed.
+	int32 animationTargetsComponentCount = INDEX_NONE;
+
+	// Whether the animation targets have to be gathered again before the next attack
+	bool animationTargetsDirty = true;
+
+	// The attack montage that was played last, so that blend outs of other montages on the same anim instances are ignored
+	UPROPERTY(Transient)
+	UAnimMontage* playingAttackAnimation = nullptr;
+
+	// Whether the montage of the attack being performed has combo windows. If so, its windows decide when the next input is taken, and its chain ends when it blends out.
+	bool attackUsesComboWindows = false;
+
+	// Whether the accept input window of the attack being performed is open
+	bool acceptInputWindowOpen = false;
+
+	// Whether the cancel window of the attack being performed is open
+	bool cancelWindowOpen = false;
+
+	// Node of the attack an input taken in an accept input window resolved to, waiting for a cancel window or for the montage to blend out. INDEX_NONE if none.
+	int32 queuedAttackNodeIndex = INDEX_NONE;
+
+	// Combo state resolved by the server. Simulated proxies follow it, and the owning client reconciles its predictions with it.
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedComboState)
+	FComboReplicatedState replicatedComboState;
+
+	// Sequence number of the last attack input this client predicted
+	uint8 predictedInputSequence = 0;
+
+	// Inputs this client has predicted that the server has not resolved yet, oldest first
+	TArray<FComboPredictedInput, TInlineAllocator<MaxPendingPredictedInputs>> pendingPredictedInputs;
+
+	// The combo state in fixed-step mode. The cursor mirrors its node so that the rest of the component reads the same state in both modes.
+	FComboRollbackState rollbackState;
+
+	UFUNCTION()
 	void OnAttackAnimationEnded(UAnimMontage *_montage, bool _wasInterrupted);
 
+	// Called when one of the watched skeletal meshes initializes a new anim instance
+	UFUNCTION()
+	void OnAnimationTargetInitialized();
+
+	UFUNCTION()
+	void OnRep_ReplicatedComboState(const FComboReplicatedState& previousState);
+
+	// Sends an attack input predicted by the owning client to the server
+	UFUNCTION(Server, Reliable)
+	void ServerAttackInput(uint8 attackInput, uint8 inputSequence);
+
+	// Sends a moveset switch of the owning client to the server, in order with its attack inputs
+	UFUNCTION(Server, Reliable)
+	void ServerSwitchMoveSet(uint8 moveSetIndex);
+
 	// Protected functions
 protected:
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	// Public functions
 public:	
 	
@@ -79,8 +285,11 @@ public:
 	// Sets default values for this component's properties
 	UComboComponent();
 
-	// Tick function
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	/// <summary>
+	/// Status of whether or not an actor can perform an attack this frame.
+	/// </summary>
+	UFUNCTION(BlueprintPure, Category = Combat)
+	bool CanAttack() const;
 
 	/// <summary>
 	/// This function should be called when the player presses an attack/action button.
@@ -89,14 +298,304 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Combat)
 	void AttackInput(AttackType_Enum attackType);
 
+	/// <summary>
+	/// Same as AttackInput, for movesets whose rows author their chains as input symbols. Symbols 0 to 2 are the attack types.
+	/// </summary>
+	/// <param name="inputSymbol:">The input symbol that is being performed.</param>
+	UFUNCTION(BlueprintCallable, Category = Combat)
+	void AttackInputSymbol(uint8 inputSymbol) { AttackInput(static_cast<AttackType_Enum>(inputSymbol)); }
+
+	/// <summary>
+	/// Queues an attack input to be performed on the next frame, or as soon as the actor can attack again within the input buffer window.
+	/// Requires bufferAttackInputs. Inputs of one component must all be buffered from the same thread.
+	/// </summary>
+	/// <param name="attackType:">The type of attack that is being performed.</param>
+	/// <returns>False if the input could not be buffered</returns>
+	UFUNCTION(BlueprintCallable, Category = Combat)
+	bool BufferAttackInput(AttackType_Enum attackType);
+
+	/// <summary>
+	/// Same as BufferAttackInput, for movesets whose rows author their chains as input symbols. Symbols 0 to 2 are the attack types.
+	/// </summary>
+	/// <param name="inputSymbol:">The input symbol that is being performed.</param>
+	/// <returns>False if the input could not be buffered</returns>
+	UFUNCTION(BlueprintCallable, Category = Combat)
+	bool BufferAttackInputSymbol(uint8 inputSymbol) { return BufferAttackInput(static_cast<AttackType_Enum>(inputSymbol)); }
+
+	/// <summary>
+	/// Queues an attack input received at the given time. Can be called from the input processing thread.
+	/// Inputs of one component must all be buffered from the same thread.
+	/// </summary>
+	/// <param name="attackType:">The type of attack that is being performed.</param>
+	/// <param name="timestamp:">Platform time at which the input was received, as returned by FPlatformTime::Seconds.</param>
+	/// <returns>False if input buffering is disabled or the buffer is full</returns>
+	bool BufferAttackInputAtTime(AttackType_Enum attackType, double timestamp);
+
+	/// <summary>
+	/// Platform time at which the last accepted attack input was received, for chord and timing logic.
+	/// </summary>
+	double GetLastAttackInputTimestamp() const { return lastAttackInputTimestamp; }
+
+	/// <summary>
+	/// Makes the component gather the owner's skeletal meshes again before the next attack.
+	/// Adding or removing components is detected automatically. Call this when a mesh is swapped out without changing the number of components.
+	/// </summary>
+	UFUNCTION(BlueprintCallable, Category = Combat)
+	void InvalidateAnimationTargets() { animationTargetsDirty = true; }
+
+	/// <summary>
+	/// Whether a combo window of the attack being performed is open.
+	/// </summary>
+	UFUNCTION(BlueprintPure, Category = Combat)
+	bool IsComboWindowOpen(EComboWindowType windowType) const { return windowType == EComboWindowType::AcceptInput ? acceptInputWindowOpen : cancelWindowOpen; }
+
+	/// <summary>
+	/// Advances the combo by one frame in fixed-step mode: counts the timers down, then performs the attack input of the frame, playing its montage.
+	/// The input can also switch to another of the switchable movesets, which fixed-step components only do this way.
+	/// </summary>
+	/// <param name="attackInput:">The attack input of the frame, an input from MakeSwitchMoveSetFrameInput, or -1 if there is none.</param>
+	UFUNCTION(BlueprintCallable, Category = Combat)
+	void SimulateFrame(int32 attackInput);
+
+	/// <summary>
+	/// The frame input that switches to one of the switchable movesets in fixed-step mode.
+	/// </summary>
+	/// <param name="moveSetIndex:">Index of the moveset in the switchable movesets.</param>
+	UFUNCTION(BlueprintPure, Category = Combat)
+	static int32 MakeSwitchMoveSetFrameInput(int32 moveSetIndex) { return ComboRollback::MakeSwitchMoveSetInput(moveSetIndex); }
+
+	/// <summary>
+	/// Snapshot of the combo state in fixed-step mode, to be restored on rollback.
+	/// </summary>
+	FComboRollbackState SaveComboState() const { return rollbackState; }
+
+	/// <summary>
+	/// Puts the combo state back to a snapshot taken with SaveComboState, including the moveset in use. Montages already playing are left alone.
+	/// </summary>
+	void RestoreComboState(const FComboRollbackState& state);
+
+	/// <summary>
+	/// Restores a snapshot and simulates one frame per input from it without any side effect, then applies the resulting state.
+	/// Used by rollback to catch up after a late input.
+	/// </summary>
+	/// <param name="fromState">The snapshot of the first frame to resimulate</param>
+	/// <param name="frameInputs">The input of each frame to resimulate, as passed to SimulateFrame. ComboRollback::NoInput for frames without one</param>
+	void ResimulateFrames(const FComboRollbackState& fromState, TArrayView<const int32> frameInputs);
+
+	/// <summary>
+	/// Whether any kind of moveset has been assigned to the component.
+	/// </summary>
+	bool HasMoveSet() const { return moveSet != nullptr || compiledMoveSet != nullptr || staticMoveSet.IsNone() == false || switchableMoveSets.Num() > 0; }
+
+	/// <summary>
+	/// Switches to another of the switchable movesets, keeping the combo going if the new moveset has the chain performed so far.
+	/// Otherwise the miss policy decides: the combo carries on from the longest suffix of the chain the new moveset has, or it is broken.
+	/// Fixed-step components switch with an input from MakeSwitchMoveSetFrameInput passed to SimulateFrame instead.
+	/// </summary>
+	/// <param name="moveSetIndex:">Index of the moveset in the switchable movesets.</param>
+	/// <returns>False if the index is out of range, the component has no switchable movesets or it is simulated at a fixed step</returns>
+	UFUNCTION(BlueprintCallable, Category = Combat)
+	bool SwitchMoveSet(int32 moveSetIndex);
+
+	/// <summary>
+	/// Index of the switchable moveset in use. 0 if the component has no switchable movesets.
+	/// </summary>
+	UFUNCTION(BlueprintPure, Category = Combat)
+	int32 GetActiveMoveSetIndex() const { return activeMoveSetIndex; }
+
+	/// <summary>
+	/// The miss policy of the moveset the component uses.
+	/// </summary>
+	EComboMissPolicy GetMissPolicy() const;
+
+	/// <summary>
+	/// The combo timings of the component in frames of the fixed-step simulation.
+	/// </summary>
+	FComboRollbackConfig GetRollbackConfig() const;
+
+	/// <summary>
+	/// The combo graph of the component's moveset, for planning queries such as which finishers can still be reached.
+	/// The graph is immutable, so the handle can be passed to other threads. Invalid until the moveset has been compiled.
+	/// </summary>
+	FComboGraphHandle GetMoveSetGraph() const { return moveSetGraph; }
+
+	/// <summary>
+	/// The node of the combo graph the actor is on, to start planning queries from. 0 when no combo is in progress.
+	/// </summary>
+	int32 GetComboNodeIndex() const { return comboCursor.nodeIndex; }
+
+	/// <summary>
+	/// Opens a combo window of the attack montage being played. Called by UComboWindowNotifyState when the window begins.
+	/// Windows of other montages are ignored.
+	/// </summary>
+	void OpenComboWindow(EComboWindowType windowType, const UAnimSequenceBase* animation);
+
+	/// <summary>
+	/// Closes a combo window of the attack montage being played. Called by UComboWindowNotifyState when the window ends.
+	/// Windows of other montages are ignored.
+	/// </summary>
+	void CloseComboWindow(EComboWindowType windowType, const UAnimSequenceBase* animation);
+
 
 	// Private functions
 private:
+	/// <summary>
+	/// Gets the shared combo graph for the assigned moveset: the active switchable moveset if there are any, then the compiled-in moveset, the cooked moveset and the table.
+	/// </summary>
+	/// <returns>False if no moveset is assigned or the moveset could not be turned into a graph</returns>
+	bool AcquireMoveSetGraph();
+
+	/// <summary>
+	/// Makes the graph of one of the switchable movesets the one in use. The cursor must already be on a node of that graph.
+	/// </summary>
+	void SetActiveMoveSet(int32 moveSetIndex);
+
+	/// <summary>
+	/// Switches moveset, moving the cursor and any queued attack over to the new graph. SwitchMoveSet without the input recording, for switches the server receives from the owning client.
+	/// </summary>
+	/// <returns>False if the component cannot switch to the moveset</returns>
+	bool ApplyMoveSetSwitch(int32 moveSetIndex);
+
+	/// <summary>
+	/// Returns the anim instances to play attack montages on, gathering them from the owner's skeletal meshes and binding their delegates if the cache is out of date.
+	/// Meshes without an anim instance are watched but not returned.
+	/// </summary>
+	const TArray<TWeakObjectPtr<UAnimInstance>>& GetAnimationTargets();
+
+	/// <summary>
+	/// Starts streaming in the montages of the attacks reachable from the current node, and releases the montages that are no longer reachable.
+	/// </summary>
+	void UpdateMontagePrefetch();
+
+	/// <summary>
+	/// Releases every montage streamed in by the component.
+	/// </summary>
+	void ReleaseMontagePrefetch();
+
+	/// <summary>
+	/// Unbinds the delegates of the cached animation targets and empties the cache.
+	/// </summary>
+	void ReleaseAnimationTargets();
+
+	/// <summary>
+	/// Sends an attack input down the path matching the component's network role: resolved on the server and in standalone games,
+	/// predicted and sent to the server on the owning client, and ignored on simulated proxies.
+	/// </summary>
+	void ProcessAttackInput(AttackType_Enum attackType, double inputTimestamp);
+
+	/// <summary>
+	/// Resolves an attack input received at the given time and applies the result.
+	/// </summary>
+	/// <returns>False if the input was ignored</returns>
+	bool ResolveAttackInput(AttackType_Enum attackType, double inputTimestamp);
+
+	/// <summary>
+	/// Resolves an attack input locally on the owning client, then sends it to the server with the next input sequence number.
+	/// </summary>
+	void PredictAttackInput(AttackType_Enum attackType, double inputTimestamp);
+
+	/// <summary>
+	/// Drops the predicted inputs the server has resolved, replays the others on top of the server's state, and moves the cursor if the prediction was wrong.
+	/// </summary>
+	void ReconcilePredictedInputs();
+
+	/// <summary>
+	/// Updates the replicated combo state on the server. Does nothing on clients.
+	/// </summary>
+	void SetReplicatedComboState(int32 attackNodeIndex, bool comboEnded);
+
+	/// <summary>
+	/// The node of the attack that was performed last in the current combo, which is the node the cursor is on. Null if no combo is in progress.
+	/// </summary>
+	const FComboGraphNode* GetLastPerformedAttack() const;
+
+	/// <summary>
+	/// Depth of the attack that was performed last in the current combo. 0 if no combo is in progress.
+	/// </summary>
+	int32 GetComboDepth() const;
+
+	/// <summary>
+	/// Records the events and plays the montage of a frame simulated in fixed-step mode.
+	/// </summary>
+	void ApplySimulatedFrame(int32 attackInput);
+
+	/// <summary>
+	/// Whether an attack input would be taken right now: the actor can attack and, if the current attack has combo windows, one of them is open and no input is queued yet.
+	/// </summary>
+	bool IsReadyForAttackInput() const;
+
+	/// <summary>
+	/// Checks whether the component can take an attack input right now, acquiring the moveset graph if needed. Must be called on the game thread.
+	/// </summary>
+	/// <returns>False if the input should be ignored</returns>
+	bool PrepareAttackInput(AttackType_Enum attackType);
+
+	/// <summary>
+	/// Applies the result of resolving an attack input against the combo graph: moves the cursor, plays the attack or resets the combo.
+	/// Must be called on the game thread.
+	/// </summary>
+	/// <param name="attackToPerform">The attack the input resolved to. Null if the input does not continue the current chain</param>
+	/// <param name="resolvedCursor">The cursor after the input was resolved</param>
+	/// <param name="inputTimestamp">Platform time at which the input was received</param>
+	void CommitAttackInput(const FComboGraphNode* attackToPerform, const FComboGraphCursor& resolvedCursor, double inputTimestamp);
+
+	/// <summary>
+	/// Moves the cursor to the attack, plays its montage and starts waiting for the next input of the chain.
+	/// </summary>
+	void PerformAttack(const FComboGraphNode* attackToPerform, const FComboGraphCursor& resolvedCursor);
+
+	/// <summary>
+	/// Performs the attack queued during an accept input window.
+	/// </summary>
+	void PerformQueuedAttack();
+
+	/// <summary>
+	/// Closes the combo windows of the current attack and drops the queued attack.
+	/// </summary>
+	void ClearComboWindows();
+
+	/// <summary>
+	/// Records a combo event of this component in the world's event ring buffer.
+	/// </summary>
+	void RecordComboEvent(EComboTraceEventType type, int32 nodeIndex = INDEX_NONE, int32 depth = 0, uint8 payload = 0) const;
+
+	/// <summary>
+	/// Plays the montage of the attack on every animation target of the owner, or requests it and plays it once loaded if it is not streamed in yet.
+	/// </summary>
+	void PlayAttackAnimation(const FComboGraphNode* attackToPerform);
+
+	/// <summary>
+	/// Plays a loaded attack montage on every animation target of the owner.
+	/// </summary>
+	void StartAttackAnimation(const FComboGraphNode* attackToPerform, UAnimMontage* attackAnimation);
+
+	/// <summary>
+	/// Called when the montage of the attack waiting for it has loaded.
+	/// </summary>
+	void OnPendingAttackAnimationLoaded();
+
+	/// <summary>
+	/// Drops the load request of the montage an attack is waiting for, if any.
+	/// </summary>
+	void CancelPendingAttackAnimation();
+
 	/// <summary>
 	/// Resets the current combo sequence. Doing this activates the attack cooldown.
 	/// </summary>
-	void ResetComboSequence();
+	/// <param name="comboCompleted">True if the combo ended because its last attack was performed, false if it was broken</param>
+	void ResetComboSequence(bool comboCompleted);
 
 	void ActivateAttackCooldown();
 
+	/// <summary>
+	/// Called by the combo subsystem when no attack input was received within the combo reset window. Resets the combo sequence if one is in progress.
+	/// </summary>
+	void OnComboResetDeadlineExpired();
+
+	/// <summary>
+	/// Called by the combo subsystem once per frame. Performs the buffered inputs in the order they were received, for as long as the actor can attack,
+	/// and drops the ones that have waited longer than the input buffer window.
+	/// </summary>
+	void DrainInputBuffer();
+
 };
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "ComboEventDumpCommandlet.generated.h"
+
+/// <summary>
+/// Reads a combo event file written by combo.DumpEvents or on a crash, and prints the timeline of every actor in it.
+/// Runs headless, for example: UnrealEditor-Cmd ComboSystem.uproject -run=ComboEventDump -file=Saved/ComboEvents/Map-Date.cmbt -nullrhi
+/// Pass -actor=Name to only print the timelines of actors whose name contains Name.
+/// </summary>
+UCLASS()
+class COMBOSYSTEM_API UComboEventDumpCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UComboEventDumpCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// <summary>
+/// The kinds of combo events that are recorded.
+/// </summary>
+enum class EComboTraceEventType : uint8
+{
+	// An attack input reached the component and was accepted. The payload is the input.
+	InputReceived,
+
+	// An attack input reached the component but was ignored, because the actor could not attack or has no moveset. The payload is the input.
+	InputIgnored,
+
+	// The input continued the chain and the cursor moved to the node
+	NodeAdvanced,
+
+	// The input did not continue the chain. The node is the one the cursor was on.
+	Miss,
+
+	// No input was received within the combo reset window
+	ComboTimedOut,
+
+	// The combo sequence was reset. The node and depth are those of the last attack performed, the payload is 1 if the combo was completed.
+	ComboReset,
+
+	// The attack recovery cooldown started
+	CooldownStarted,
+
+	// The attack recovery cooldown ended
+	CooldownEnded,
+
+	// The montage of the node started playing
+	MontageStarted,
+
+	// The attack montage blended out. The payload is 1 if it was interrupted.
+	MontageEnded,
+
+	// A combo window of the attack montage opened. The payload is the EComboWindowType.
+	ComboWindowOpened,
+
+	// A combo window of the attack montage closed. The payload is the EComboWindowType.
+	ComboWindowClosed,
+
+	// An input taken in an accept input window is waiting to be performed. The node is the queued attack.
+	AttackQueued,
+
+	// The owning client predicted its combo wrongly and moved its cursor to the server's. The node is the corrected one, the payload the last input sequence the server resolved.
+	PredictionCorrected,
+
+	// An input that did not continue the chain carried the combo on from a shorter chain, under the resume miss policy. The payload is the depth the combo was at.
+	ComboResumed,
+
+	// The component switched to another of its switchable movesets. The node and depth are those the cursor was mapped to, the payload is the new moveset index.
+	MoveSetSwitched
+};
+
+/// <summary>
+/// One recorded combo event. Plain data, so that recording it is a copy into the ring buffer.
+/// </summary>
+struct FComboTraceEvent
+{
+	// World time of the event, in seconds
+	double time = 0.0;
+
+	// Unique id of the combo component the event belongs to
+	uint32 componentId = 0;
+
+	// Node of the combo graph the event refers to. INDEX_NONE if none.
+	int32 nodeIndex = INDEX_NONE;
+
+	// Depth of the node
+	uint16 depth = 0;
+
+	EComboTraceEventType type = EComboTraceEventType::InputReceived;
+
+	// Meaning depends on the type of event
+	uint8 payload = 0;
+};
+
+/// <summary>
+/// Fixed size ring buffer of binary combo events. Recording an event never allocates or formats strings, the oldest events are overwritten once the buffer is full.
+/// The buffer can be written to a compact file, along with the names of the actors whose components appear in it, and read back to rebuild per-actor timelines.
+/// Game thread only.
+/// </summary>
+class COMBOSYSTEM_API ComboEventRecorder
+{
+public:
+	// Number of events kept in the buffer
+	static constexpr int32 Capacity = 4096;
+
+	// Marks the start of an event file
+	static constexpr uint32 FileMagic = 0x54424D43; // 'CMBT'
+
+	// Layout version of event files. Bump this whenever the event struct or the file layout changes.
+	static constexpr uint32 FileVersion = 1;
+
+	/// <summary>
+	/// Adds an event to the buffer, overwriting the oldest one if the buffer is full.
+	/// </summary>
+	void Record(const FComboTraceEvent& event)
+	{
+		events[recordedEventCount % Capacity] = event;
+		recordedEventCount++;
+	}
+
+	/// <summary>
+	/// Remembers the name of the actor owning a component, so that dumps can show it. Not meant for the hot path.
+	/// </summary>
+	void RegisterComponentName(uint32 componentId, FName actorName);
+
+	/// <summary>
+	/// Copies the events still in the buffer, oldest first.
+	/// </summary>
+	void CopyEvents(TArray<FComboTraceEvent>& outEvents) const;
+
+	/// <summary>
+	/// Writes the events still in the buffer and the names of their actors to a file.
+	/// </summary>
+	/// <returns>False if the file could not be written</returns>
+	bool WriteToFile(const FString& fileName) const;
+
+	/// <summary>
+	/// Reads a file written by WriteToFile.
+	/// </summary>
+	/// <param name="fileName">The file to read</param>
+	/// <param name="outEvents">The events in the file, oldest first</param>
+	/// <param name="outComponentNames">Name of the actor owning each component that appears in the events</param>
+	/// <returns>False if the file could not be read or was written with a different layout version</returns>
+	static bool ReadFromFile(const FString& fileName, TArray<FComboTraceEvent>& outEvents, TMap<uint32, FString>& outComponentNames);
+
+	/// <summary>
+	/// Readable name of an event type.
+	/// </summary>
+	static const TCHAR* GetEventTypeName(EComboTraceEventType type);
+
+	// Total number of events recorded since the recorder was created, including the ones that have been overwritten
+	uint64 GetRecordedEventCount() const { return recordedEventCount; }
+
+private:
+	TStaticArray<FComboTraceEvent, Capacity> events;
+
+	uint64 recordedEventCount = 0;
+
+	// Name of the actor owning each component that has recorded events
+	TMap<uint32, FName> componentNames;
+};
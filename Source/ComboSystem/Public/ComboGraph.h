@@ -1,12 +1,21 @@
 #pragma once
 
 #include "FAttackAction_Struct.h"
+#include "HAL/LowLevelMemTracker.h"
 #include "ComboGraph.generated.h"
 
+// Low level memory tracker tag for everything the combo graphs allocate
+LLM_DECLARE_TAG_API(ComboGraph, COMBOSYSTEM_API);
+
+struct FComboGraphDiagnostic;
+struct FComboStaticMovesetTable;
+class UAnimMontage;
+
 
 /// <summary>
 /// This struct represents one node in the graph.
 /// A node in the graph represents one attack in the moveset.
+/// Nodes are stored in one contiguous array owned by the graph and refer to each other by index.
 /// </summary>
 USTRUCT(BlueprintType)
 struct FComboGraphNode
@@ -14,60 +23,578 @@ struct FComboGraphNode
 	GENERATED_USTRUCT_BODY()
 
 public:
-	// This represents the previous attack chain that needs to be achieved to reach this attack.
-	FComboGraphNode* parentNode;
+	// Index of the previous attack in the chain that needs to be achieved to reach this attack. The root node uses INDEX_NONE.
+	int32 parentIndex = INDEX_NONE;
+
+	// Index of the first of the next possible attacks that can be performed after this. Children of a node are always stored next to each other.
+	int32 firstChildIndex = 0;
+
+	// Number of next possible attacks that can be performed after this.
+	int32 childCount = 0;
+
+	// Number of inputs required to reach this node. The root node sits at depth 0.
+	int32 depth = 0;
+};
+
+
+/// <summary>
+/// What happens when an input does not continue the current chain.
+/// </summary>
+UENUM(BlueprintType)
+enum class EComboMissPolicy : uint8
+{
+	// The combo is broken and the attack recovery cooldown starts
+	ResetWithCooldown,
+
+	// The combo carries on from the longest suffix of the recent inputs, followed by the new input, that is still a valid chain.
+	// The combo is only broken if no such chain exists, not even the new input on its own.
+	ResumeAtLongestSuffix
+};
+
+
+/// <summary>
+/// The data of the attack a node represents, taken from the moveset table row the node was compiled from.
+/// Montages are soft references so that a compiled graph does not force every montage in the moveset to be loaded.
+/// </summary>
+USTRUCT(BlueprintType)
+struct COMBOSYSTEM_API FComboGraphMoveData
+{
+	GENERATED_USTRUCT_BODY()
+
+	/// <summary>
+	/// The moveset table row this attack was compiled from. None for the root node.
+	/// </summary>
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FName rowName;
+
+	/// <summary>
+	/// The name for the attack.
+	/// </summary>
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FString moveName;
+
+	/// <summary>
+	/// The animation to be used for this attack.
+	/// </summary>
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TSoftObjectPtr<UAnimMontage> attackAnimation;
+};
 
-	// This represents the next possible attacks that can be performed after this.
-	TArray<FComboGraphNode*> childrenNodes;
 
-	// The data entry in the combo table for this particular attack.
-	FAttackAction_Struct* attackData;
+/// <summary>
+/// Header at the start of a compiled graph image.
+/// A graph image is one block of memory holding everything the graph needs for lookups, laid out as:
+/// header, node array, packed attack chain index slots, failure links, node ranges, finishers, transition bytes, padding so that the transition bytes can be read 16 at a time.
+/// The same image is used in memory and on disk, so a cooked image is used as-is without any per-node parsing.
+/// </summary>
+struct alignas(16) FComboGraphImageHeader
+{
+	// Always ComboGraph::ImageMagic
+	uint32 magic = 0;
+
+	// Layout version of the image, ComboGraph::ImageVersion when the image was written
+	uint32 version = 0;
+
+	// Total size of the image in bytes, including this header
+	uint32 imageSize = 0;
+
+	// Number of nodes in the graph, including the root node
+	int32 nodeCount = 0;
+
+	// The depth of the tree
+	int32 treeDepth = -1;
+
+	// Number of slots in the packed attack chain index. Always a power of two.
+	int32 indexSlotCount = 0;
+
+	// Number of bits used for each input of an attack chain in a packed key, enough for the largest input used by the moveset
+	int32 packedBitsPerInput = 0;
+
+	// Number of finishers, the nodes that end their chain
+	int32 finisherCount = 0;
+
+	// Offsets of each section from the start of the image
+	uint32 nodesOffset = 0;
+	uint32 indexSlotsOffset = 0;
+	uint32 failureLinksOffset = 0;
+	uint32 nodeRangesOffset = 0;
+	uint32 finishersOffset = 0;
+	uint32 transitionInputsOffset = 0;
+};
+
+
+/// <summary>
+/// One slot of the packed attack chain index, which is an open addressing hash table stored inside the graph image.
+/// </summary>
+struct FComboGraphIndexSlot
+{
+	// Packed key of the attack chain. 0 marks an empty slot, since every packed key has its start marker bit set.
+	uint64 packedChain = 0;
+
+	// The node the attack chain leads to
+	int32 nodeIndex = INDEX_NONE;
+
+	int32 padding = 0;
+};
+
+
+/// <summary>
+/// Precomputed ranges of one node of a graph image, which answer reachability queries without walking the graph.
+/// The image holds one more range than there are nodes, so that the range after the last node can always be read.
+/// </summary>
+struct FComboGraphNodeRange
+{
+	// Position of the node in a depth-first walk of the graph. The nodes reachable from this node are exactly those positioned in (preorderIndex, subtreeEnd).
+	int32 preorderIndex = 0;
+	int32 subtreeEnd = 0;
+
+	// Index where the children of this node start, even when it has none. The children of a run of nodes on one level are [childRangeStart of the first, childRangeStart of the one after the last).
+	int32 childRangeStart = 0;
+
+	// Number of finishers before this node in node order, which is where the finishers of a run of nodes start in the finisher array
+	int32 finisherRank = 0;
+};
+
+
+/// <summary>
+/// Position of an actor within a combo graph.
+/// The cursor starts on the root node and moves one edge along the graph per input, so it never needs to store the attack chain performed so far.
+/// </summary>
+struct FComboGraphCursor
+{
+	// Index of the node the cursor currently sits on. Index 0 is the root node.
+	int32 nodeIndex = 0;
+
+	// Moves the cursor back to the root node
+	void Reset() { nodeIndex = 0; }
+
+	// Whether the cursor is on the root node, meaning no attack has been performed yet
+	bool IsAtRoot() const { return nodeIndex == 0; }
 };
 
 
 /// <summary>
 /// This graph represents the entire moveset contained in the data table in graph form.
+/// The graph is compiled into a single allocation: a breadth-first ordered node array followed by the transition bytes,
+/// where the transition byte at index i is the input that leads into node i.
 /// </summary>
 class ComboGraph
 {
+	// The compiler validates and orders the moveset rows, then hands the compiled nodes over to the graph
+	friend class ComboGraphCompiler;
+
+	// Moveset libraries replace the move data and images of their graphs with ones shared by every graph of the library
+	friend class ComboMoveSetLibrary;
+
 	// Private variables/properties
 private:
 	/// <summary>
-	/// Root for the entire combo graph. The root node will always be a non-attack representing the starting point of a combo where no attack has been performed yet.
+	/// The graph image when the graph owns it. Null when the graph uses an image owned by someone else, such as a cooked moveset asset or another graph.
+	/// </summary>
+	void* ownedImage = nullptr;
+
+	/// <summary>
+	/// Graph of the same shape whose image this graph uses, kept alive for as long as this graph uses it. Null unless the graph belongs to a moveset library.
+	/// </summary>
+	TSharedPtr<const ComboGraph, ESPMode::ThreadSafe> imageOwner;
+
+	/// <summary>
+	/// Header of the image the graph uses, whether it owns it or not.
+	/// </summary>
+	const FComboGraphImageHeader* imageHeader = nullptr;
+
+	/// <summary>
+	/// All nodes of the graph in breadth-first order. The node at index 0 is the root, which is a non-attack representing the starting point of a combo where no attack has been performed yet.
+	/// </summary>
+	const FComboGraphNode* nodes = nullptr;
+
+	/// <summary>
+	/// Index from the packed key of an attack chain to the node it leads to.
+	/// Only holds chains short enough to be packed into a single key, longer chains are found by walking the graph.
 	/// </summary>
-	FComboGraphNode rootNode;
+	const FComboGraphIndexSlot* indexSlots = nullptr;
 
+	/// <summary>
+	/// Failure link of every node, as in an Aho-Corasick automaton: the node of the longest proper suffix of the node's attack chain that is also a chain of the graph.
+	/// Suffix nodes without children can never match the next input, so links skip over them. The root links to itself.
+	/// </summary>
+	const int32* failureLinks = nullptr;
+
+	/// <summary>
+	/// Range of every node, plus one past the last node.
+	/// </summary>
+	const FComboGraphNodeRange* nodeRanges = nullptr;
+
+	/// <summary>
+	/// Index of every finisher, the nodes that end their chain, in node order.
+	/// </summary>
+	const int32* finishers = nullptr;
+
+	/// <summary>
+	/// Input required to move into each node from its parent. Kept apart from the nodes so that matching the children of a node only touches these bytes.
+	/// </summary>
+	const uint8* transitionInputs = nullptr;
+
+	/// <summary>
+	/// Dense transition table of a moveset compiled into the game: the next node for every node and input column. Null for every other graph.
+	/// </summary>
+	const int32* denseTransitions = nullptr;
+
+	/// <summary>
+	/// Column of the dense transition table for each input.
+	/// </summary>
+	const uint16* denseInputSymbols = nullptr;
+
+	// Number of columns of the dense transition table
+	int32 denseSymbolCount = 0;
+
+	// Number of nodes in the graph, including the root node
+	int32 nodeCount = 0;
+
+	// Number of index slots minus one, used to wrap probes around the index
+	int32 indexSlotMask = 0;
+
+	// Number of bits used for each input of an attack chain in a packed key
+	int32 packedBitsPerInput = 0;
+
+	// Longest attack chain that fits in a packed key of this graph
+	int32 maxPackedAttackChainLength = 0;
 
 	// The depth of the current tree
 	int treeDepth = -1;
 
+	/// <summary>
+	/// Move data of every node when the graph owns it.
+	/// </summary>
+	TArray<FComboGraphMoveData> ownedMoveData;
+
+	/// <summary>
+	/// Move data of every node, indexed the same way as the nodes unless the move data is shared. The entry of the root node is empty.
+	/// </summary>
+	const FComboGraphMoveData* moveData = nullptr;
+
+	/// <summary>
+	/// Move data shared with the other graphs of a moveset library, where every node performing the same move shares one entry. Null unless the graph belongs to a library.
+	/// </summary>
+	TSharedPtr<const TArray<FComboGraphMoveData>, ESPMode::ThreadSafe> sharedMoveData;
+
+	/// <summary>
+	/// Entry of each node in the shared move data. Empty unless the move data is shared.
+	/// </summary>
+	TArray<int32> sharedMoveIndices;
+
+	// Memory reported to the combo graph memory stat for this graph, so that exactly the same amount is removed when the graph is released
+	SIZE_T trackedAllocatedSize = 0;
+
+	// Private functions
+private:
+	/// <summary>
+	/// Frees the compiled graph memory.
+	/// </summary>
+	void ReleaseGraphMemory();
+
+	/// <summary>
+	/// Checks the header of an image before it is used in place.
+	/// </summary>
+	static bool IsValidImage(const uint8* image, int32 imageSize, int32 moveDataCount);
+
+	/// <summary>
+	/// Points the graph at the sections of an image whose header has already been checked.
+	/// </summary>
+	void AttachImage(const uint8* image, const FComboGraphMoveData* imageMoveData);
+
+	/// <summary>
+	/// Replaces the contents of the graph with nodes produced by the compiler. Builds a graph image owned by the graph, including the packed attack chain index.
+	/// </summary>
+	/// <param name="compiledNodes">Nodes in breadth-first order, with the root node first and the children of every node next to each other</param>
+	/// <param name="compiledInputs">Input that leads into each of the compiled nodes</param>
+	/// <param name="compiledMoveData">Move data of each of the compiled nodes</param>
+	void InitializeFromCompiledNodes(TArrayView<const FComboGraphNode> compiledNodes, TArrayView<const uint8> compiledInputs, TArray<FComboGraphMoveData>&& compiledMoveData);
+
+	/// <summary>
+	/// Returns the index of the child of the given node that is reached with the given input, or INDEX_NONE if there is none.
+	/// </summary>
+	int32 FindChildWithInput(int32 nodeIndex, uint8 input) const;
+
+	/// <summary>
+	/// Moves a run of nodes on one level to the run of their children on the next level, which is contiguous in the node array.
+	/// Costs two range lookups, whatever the number of nodes in the run.
+	/// </summary>
+	/// <param name="levelStart">First node of the run</param>
+	/// <param name="levelEnd">One past the last node of the run</param>
+	/// <returns>False if the nodes of the run have no children</returns>
+	bool AdvanceLevelRange(int32& levelStart, int32& levelEnd) const;
+
+	/// <summary>
+	/// Replaces the move data of the graph with entries of move data shared with other graphs.
+	/// </summary>
+	/// <param name="libraryMoveData">The shared move data</param>
+	/// <param name="nodeMoveIndices">Entry of each node in the shared move data</param>
+	void ShareMoveData(const TSharedRef<const TArray<FComboGraphMoveData>, ESPMode::ThreadSafe>& libraryMoveData, TArray<int32>&& nodeMoveIndices);
+
+	/// <summary>
+	/// Frees the image of the graph and uses the one of another graph of the same shape instead. The move data is kept.
+	/// </summary>
+	/// <param name="owner">The graph whose image to use</param>
+	void ShareImage(const TSharedRef<const ComboGraph, ESPMode::ThreadSafe>& owner);
+
+	/// <summary>
+	/// Probes the packed attack chain index for the given chain.
+	/// </summary>
+	/// <param name="attackChainToFind">The attack chain to look for</param>
+	/// <param name="outNode">The found node, null if the chain is not in the graph</param>
+	/// <returns>False if the chain cannot be packed and the caller needs to walk the graph instead</returns>
+	bool ProbePackedAttackChainIndex(const TArray<TEnumAsByte<AttackType_Enum>>& attackChainToFind, const FComboGraphNode*& outNode) const;
+
+	/// <summary>
+	/// Returns the first index slot to probe for the given packed key.
+	/// </summary>
+	static int32 GetFirstIndexSlot(uint64 packedChain, int32 slotMask) { return static_cast<int32>((packedChain * 0x9E3779B97F4A7C15ull) >> 32) & slotMask; }
+
+
+	// Public variables/properties
+public:
+	// Number of distinct inputs a graph can transition on. Inputs are bytes, so game specific inputs such as directions, stances, chords or context inputs
+	// can be used next to the attack types.
+	static constexpr int32 MaxInputSymbols = 256;
+
+	// Number of bytes readable past the last transition input of an image, so that the inputs of any node's children can be matched 16 at a time
+	static constexpr int32 TransitionInputPadding = 15;
+
+	// Key of the empty attack chain, which leads to the root node
+	static constexpr uint64 EmptyPackedAttackChain = 1;
+
+	// Marks the start of a graph image
+	static constexpr uint32 ImageMagic = 0x47424D43; // 'CMBG'
+
+	// Layout version of graph images. Bump this whenever the image layout or the node struct changes, so that stale cooked images are rejected.
+	static constexpr uint32 ImageVersion = 4;
+
+	/// <summary>
+	/// Appends an input to a packed attack chain key.
+	/// </summary>
+	static uint64 AppendToPackedAttackChain(uint64 packedChain, uint8 input, int32 bitsPerInput) { return (packedChain << bitsPerInput) | input; }
+
+	/// <summary>
+	/// Longest attack chain that fits in a packed key using the given number of bits per input. One bit of the key is reserved to mark where the chain starts.
+	/// </summary>
+	static int32 GetMaxPackedAttackChainLength(int32 bitsPerInput) { return (64 - 1) / bitsPerInput; }
+
+	/// <summary>
+	/// Packs an attack chain into a single integer key, using the number of bits per input of this graph.
+	/// </summary>
+	/// <param name="attackChain">The attack chain to pack</param>
+	/// <param name="outPackedChain">The packed key</param>
+	/// <returns>False if the chain is too long or contains an input that does not fit in a packed key</returns>
+	bool PackAttackChain(const TArray<TEnumAsByte<AttackType_Enum>>& attackChain, uint64& outPackedChain) const;
 
 	// Public functions
 public:
 
+	ComboGraph() = default;
+	~ComboGraph();
+
+	// The graph owns its memory, so it cannot be copied
+	ComboGraph(const ComboGraph&) = delete;
+	ComboGraph& operator=(const ComboGraph&) = delete;
+
 	/// <summary>
 	/// This function uses the data table provided to create a combo graph contained within. Use this to initialize the graph.
 	/// </summary>
 	/// <param name="movesetTable">The table to create a moveset from</param>
-	void CreateComboGraph(UDataTable* movesetTable);
+	/// <returns>False if the table could not be compiled into a graph</returns>
+	bool CreateComboGraph(UDataTable* movesetTable);
+
+	/// <summary>
+	/// This function uses the data table provided to create a combo graph contained within, and reports any problems found in the moveset.
+	/// Rows with problems are left out of the graph.
+	/// </summary>
+	/// <param name="movesetTable">The table to create a moveset from</param>
+	/// <param name="outDiagnostics">Problems found in the moveset</param>
+	/// <returns>False if the table could not be compiled into a graph</returns>
+	bool CreateComboGraph(UDataTable* movesetTable, TArray<FComboGraphDiagnostic>& outDiagnostics);
+
+	/// <summary>
+	/// Initializes the graph from a compiled graph image, such as one loaded from a cooked moveset asset. The image is used in place without being copied,
+	/// so both the image and the move data must outlive the graph.
+	/// </summary>
+	/// <param name="image">The graph image</param>
+	/// <param name="imageSize">Size of the image in bytes</param>
+	/// <param name="imageMoveData">Move data of every node in the image</param>
+	/// <param name="imageMoveDataCount">Number of entries in the move data, which must match the number of nodes</param>
+	/// <returns>False if the image is invalid or was written with a different layout version</returns>
+	bool InitializeFromImage(const uint8* image, int32 imageSize, const FComboGraphMoveData* imageMoveData, int32 imageMoveDataCount);
+
+	/// <summary>
+	/// Initializes the graph from a moveset compiled into the game. The image and transition table are used in place,
+	/// and every input is then resolved with a single index into the transition table instead of a scan of the node's children.
+	/// </summary>
+	/// <param name="staticMoveset">The compiled-in moveset</param>
+	/// <returns>False if the moveset was generated for a different image layout version</returns>
+	bool InitializeFromStaticMoveset(const FComboStaticMovesetTable& staticMoveset);
+
+	/// <summary>
+	/// Copies the graph image into the given array, so that it can be saved and later passed to InitializeFromImage.
+	/// </summary>
+	void CopyImage(TArray<uint8>& outImage) const;
+
+	/// <summary>
+	/// Copies the move data of every node into the given array, so that it can be saved alongside the graph image.
+	/// </summary>
+	void CopyMoveData(TArray<FComboGraphMoveData>& outMoveData) const;
 
 	/// <summary>
-	/// This function does a breadth-first search of the graph to find a node whose attack chain matches the one provided as the parameter
+	/// This function finds a node whose attack chain matches the one provided as the parameter.
+	/// Chains that fit in a packed key are found with a single index probe, longer chains fall back to walking the graph.
 	/// </summary>
 	/// <param name="attackChainToFind">The attack chain to look for</param>
 	/// <returns>Pointer to the found node. Null if the node cannot be found</returns>
-	FComboGraphNode* FindNodeWithAttackChain(TArray<TEnumAsByte<AttackType_Enum>> attackChainToFind);
+	const FComboGraphNode* FindNodeWithAttackChain(const TArray<TEnumAsByte<AttackType_Enum>>& attackChainToFind) const;
 
 	/// <summary>
-	/// This function does a fast (single iteration depth-first) search of the graph to find the node with the matching attack sequence.
+	/// This function does a fast search of the graph to find the node with the matching attack sequence.
+	/// Chains that fit in a packed key are found with a single index probe, longer chains fall back to a single iteration depth-first walk.
 	/// </summary>
 	/// <param name="attackChainToFind">The attack chain to look for</param>
 	/// <returns>Pointer to the found node. Null if the node cannot be found</returns>
-	FComboGraphNode* FastFindNodeWithAttackChain(TArray<TEnumAsByte<AttackType_Enum>> attackChainToFind);
+	const FComboGraphNode* FastFindNodeWithAttackChain(const TArray<TEnumAsByte<AttackType_Enum>>& attackChainToFind) const;
 
 
-	FComboGraphNode* FastFindNodeWithLastPerformedAttack(TArray<TEnumAsByte<AttackType_Enum>> currentSequence, FComboGraphNode* lastAttackNode);
+	const FComboGraphNode* FastFindNodeWithLastPerformedAttack(const TArray<TEnumAsByte<AttackType_Enum>>& currentSequence, const FComboGraphNode* lastAttackNode) const;
+
+	/// <summary>
+	/// Moves the cursor one edge along the graph from the node it currently sits on.
+	/// This does not allocate and costs a single scan of the current node's children.
+	/// </summary>
+	/// <param name="cursor">The cursor to advance. It is left untouched if the input does not continue the chain</param>
+	/// <param name="input">The input that was performed</param>
+	/// <returns>Pointer to the node the cursor moved to. Null if no attack follows the current node with this input</returns>
+	const FComboGraphNode* AdvanceCursor(FComboGraphCursor& cursor, uint8 input) const;
+
+	/// <summary>
+	/// Moves the cursor one edge along the graph, applying the miss policy when the input does not continue the chain.
+	/// </summary>
+	/// <param name="cursor">The cursor to advance. It is left untouched if the input does not lead to any attack</param>
+	/// <param name="input">The input that was performed</param>
+	/// <param name="missPolicy">What to do when the input does not continue the chain</param>
+	/// <returns>Pointer to the node the cursor moved to. Null if the input does not lead to any attack under the policy</returns>
+	const FComboGraphNode* AdvanceCursor(FComboGraphCursor& cursor, uint8 input, EComboMissPolicy missPolicy) const;
+
+	/// <summary>
+	/// Moves the cursor to the node of the longest suffix of its attack chain, followed by the input, that is a chain of the graph.
+	/// Follows failure links, so the cost does not depend on the size of the graph. Each link is a shorter suffix, so the walk is bounded by the depth of the cursor.
+	/// </summary>
+	/// <param name="cursor">The cursor to move. It is left untouched if no suffix leads to an attack</param>
+	/// <param name="input">The input that did not continue the chain</param>
+	/// <returns>Pointer to the node the cursor moved to. Null if not even the input on its own is an attack</returns>
+	const FComboGraphNode* ResumeCursorAfterMiss(FComboGraphCursor& cursor, uint8 input) const;
+
+	/// <summary>
+	/// Returns the failure link of a node, or INDEX_NONE if the index is out of range.
+	/// </summary>
+	int32 GetFailureLink(int32 nodeIndex) const { return (nodeIndex >= 0 && nodeIndex < nodeCount) ? failureLinks[nodeIndex] : INDEX_NONE; }
+
+	/// <summary>
+	/// Walks down the graph from the given node, consuming the inputs of the sequence that come after the node's depth.
+	/// </summary>
+	/// <param name="currentSequence">The full attack chain performed so far</param>
+	/// <param name="searchRootNode">The node to start walking from. Must be a node on the path of the sequence</param>
+	/// <returns>Pointer to the found node. Null if the node cannot be found</returns>
+	const FComboGraphNode* SearchGraphStartingFromRootNode(const TArray<TEnumAsByte<AttackType_Enum>>& currentSequence, const FComboGraphNode* searchRootNode) const;
+
+	/// <summary>
+	/// Gathers the nodes that can be reached from the given node in at most maxDepth inputs, level by level.
+	/// The descendants of a node on each level are contiguous in the node array, so the cost only depends on maxDepth and the number of nodes found.
+	/// </summary>
+	/// <param name="nodeIndex">The node to start from. It is not included in the result</param>
+	/// <param name="maxDepth">How many inputs ahead to look. 1 gathers the children of the node only</param>
+	/// <param name="outNodeIndices">Array the indices of the reachable nodes are appended to</param>
+	void GetReachableNodeIndices(int32 nodeIndex, int32 maxDepth, TArray<int32>& outNodeIndices) const;
+
+	// Reachability queries. They only read the immutable graph image, so they can run on any thread, and none of them walks the graph.
+
+	/// <summary>
+	/// Whether the target node can be reached from the given node by continuing its chain. Constant time.
+	/// </summary>
+	bool IsReachable(int32 fromNodeIndex, int32 toNodeIndex) const;
+
+	/// <summary>
+	/// Number of inputs needed to reach the target node from the given node, or INDEX_NONE if it cannot be reached. Constant time.
+	/// Every node has a single chain leading to it, so this is also the shortest distance.
+	/// </summary>
+	int32 GetInputDistance(int32 fromNodeIndex, int32 toNodeIndex) const;
+
+	/// <summary>
+	/// Gives the inputs that lead from the given node to the target node. The cost is proportional to the number of inputs.
+	/// </summary>
+	/// <param name="fromNodeIndex">The node to start from, such as the node the cursor is on</param>
+	/// <param name="toNodeIndex">The node to reach</param>
+	/// <param name="outInputs">The inputs to perform, in order. Empty if the nodes are the same</param>
+	/// <returns>False if the target node cannot be reached from the given node</returns>
+	bool GetShortestInputSequence(int32 fromNodeIndex, int32 toNodeIndex, TArray<uint8>& outInputs) const;
+
+	/// <summary>
+	/// Gathers the finishers, the attacks that end their chain, that can be reached from the given node in at most maxInputs inputs.
+	/// The cost only depends on maxInputs and the number of finishers found.
+	/// </summary>
+	/// <param name="nodeIndex">The node to start from. It is not included in the result</param>
+	/// <param name="maxInputs">How many inputs ahead to look</param>
+	/// <param name="outFinisherIndices">Array the indices of the reachable finishers are appended to, nearest first</param>
+	void GetReachableFinishers(int32 nodeIndex, int32 maxInputs, TArray<int32>& outFinisherIndices) const;
+
+	/// <summary>
+	/// Number of nodes that can be reached from the given node, however many inputs it takes. Constant time.
+	/// </summary>
+	int32 GetReachableNodeCount(int32 nodeIndex) const;
+
+	/// <summary>
+	/// Returns the root node of the graph, or null if the graph has not been created.
+	/// </summary>
+	const FComboGraphNode* GetRootNode() const { return nodeCount > 0 ? nodes : nullptr; }
+
+	/// <summary>
+	/// Returns the node at the given index, or null if the index is out of range.
+	/// </summary>
+	const FComboGraphNode* GetNode(int32 nodeIndex) const { return (nodeIndex >= 0 && nodeIndex < nodeCount) ? &nodes[nodeIndex] : nullptr; }
+
+	/// <summary>
+	/// Returns the index of a node belonging to this graph.
+	/// </summary>
+	int32 GetNodeIndex(const FComboGraphNode* node) const { return static_cast<int32>(node - nodes); }
+
+	/// <summary>
+	/// Returns the data of the attack a node belonging to this graph represents.
+	/// </summary>
+	const FComboGraphMoveData& GetMoveData(const FComboGraphNode* node) const
+	{
+		const int32 nodeIndex = GetNodeIndex(node);
+		return moveData[sharedMoveIndices.Num() > 0 ? sharedMoveIndices[nodeIndex] : nodeIndex];
+	}
+
+	/// <summary>
+	/// Returns the moveset table row a node belonging to this graph was compiled from. None for the root node.
+	/// In a moveset library, where nodes performing the same move share their move data, the row of the first node the move was found on.
+	/// </summary>
+	FName GetRowName(const FComboGraphNode* node) const { return GetMoveData(node).rowName; }
+
+	/// <summary>
+	/// Returns the input that leads into a node from its parent, or 0 if the index is out of range.
+	/// </summary>
+	uint8 GetTransitionInput(int32 nodeIndex) const { return (nodeIndex >= 0 && nodeIndex < nodeCount) ? transitionInputs[nodeIndex] : 0; }
+
+	/// <summary>
+	/// Size of the graph image in bytes. 0 if the graph has not been created.
+	/// </summary>
+	int32 GetImageSize() const { return imageHeader != nullptr ? static_cast<int32>(imageHeader->imageSize) : 0; }
+
+	/// <summary>
+	/// Memory allocated by the graph itself, in bytes. Images and move data used in place from a cooked asset or shared with other graphs are not counted.
+	/// </summary>
+	SIZE_T GetAllocatedSize() const;
 
-	FComboGraphNode* SearchGraphStartingFromRootNode(TArray<TEnumAsByte<AttackType_Enum>> currentSequence, FComboGraphNode* searchRootNode);
+	// Number of nodes in the graph, including the root node
+	int32 GetNodeCount() const { return nodeCount; }
 
+	// The depth of the tree, which is the length of the longest attack chain
+	int GetTreeDepth() const { return treeDepth; }
 };
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "ComboGraphBenchmarkCommandlet.generated.h"
+
+/// <summary>
+/// Benchmarks the combo graph against synthetic movesets and writes the results as CSV and JSON, so that regressions can be tracked between versions.
+/// Runs headless, for example: UnrealEditor-Cmd ComboSystem.uproject -run=ComboGraphBenchmark -nullrhi
+/// Every moveset parameter takes a comma separated list of values, and every combination of them is benchmarked:
+/// -rows=1000 -depth=8 -branching=3 -alphabet=3, where the alphabet can go up to 256 inputs. Other parameters are -lookups=, -builds=, -seed=, -label= to tag the run,
+/// and -output= for the directory the results are written to (Saved/ComboBenchmarks by default).
+/// For each moveset the build time, the latency percentiles of hit and missed lookups, the allocations per input and the memory used by the graph are measured.
+/// </summary>
+UCLASS()
+class COMBOSYSTEM_API UComboGraphBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UComboGraphBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ComboGraph.h"
+#include "UObject/ObjectKey.h"
+
+class ComboMoveSetLibrary;
+class UComboMovesetAsset;
+struct FComboStaticMovesetTable;
+
+
+/// <summary>
+/// Shared, read-only handle to a compiled combo graph.
+/// </summary>
+typedef TSharedPtr<const ComboGraph, ESPMode::ThreadSafe> FComboGraphHandle;
+
+
+/// <summary>
+/// Shared, read-only handle to a library of switchable movesets.
+/// </summary>
+typedef TSharedPtr<const ComboMoveSetLibrary, ESPMode::ThreadSafe> FComboMoveSetLibraryHandle;
+
+
+/// <summary>
+/// Process-wide cache of compiled combo graphs, keyed by the moveset table or cooked moveset asset they come from.
+/// Every component using the same table shares a single graph. The cache only keeps weak references, so a graph is freed as soon as the last handle to it is released.
+/// The cache must only be used from the game thread. The graphs it hands out are immutable and can be read from any thread.
+/// </summary>
+class COMBOSYSTEM_API ComboGraphCache
+{
+public:
+	/// <summary>
+	/// Returns the compiled graph for the given table, compiling it the first time the table is requested.
+	/// </summary>
+	/// <param name="movesetTable">The table to get the graph for</param>
+	/// <returns>Handle to the graph. Invalid if the table could not be compiled</returns>
+	static FComboGraphHandle Acquire(UDataTable* movesetTable);
+
+	/// <summary>
+	/// Returns the graph for the given cooked moveset, using the graph image stored in the asset in place.
+	/// Falls back to compiling the asset's source table if the asset has no valid image and the table is already loaded. The table is never loaded here, since that would stall the game thread.
+	/// The cache keeps the asset alive for as long as the graph uses its image.
+	/// </summary>
+	/// <param name="movesetAsset">The cooked moveset to get the graph for</param>
+	/// <returns>Handle to the graph. Invalid if the asset holds no valid image and its source table is not loaded or could not be compiled</returns>
+	static FComboGraphHandle Acquire(UComboMovesetAsset* movesetAsset);
+
+	/// <summary>
+	/// Returns the graph for a moveset compiled into the game. Compiled-in movesets live for the whole process, so their graphs are kept once created.
+	/// </summary>
+	/// <param name="staticMoveset">The compiled-in moveset to get the graph for</param>
+	/// <returns>Handle to the graph. Invalid if the moveset was generated for a different image layout version</returns>
+	static FComboGraphHandle Acquire(const FComboStaticMovesetTable* staticMoveset);
+
+	/// <summary>
+	/// Returns the library of the given switchable movesets, building it the first time this list of tables is requested.
+	/// Libraries are cached weakly by their list of tables, like graphs, so every component switching between the same movesets shares one library.
+	/// </summary>
+	/// <param name="movesetTables">The tables of the movesets, in the order they are switched to by index</param>
+	/// <returns>Handle to the library. Invalid if there are no tables or any of them could not be compiled</returns>
+	static FComboMoveSetLibraryHandle AcquireLibrary(TArrayView<UDataTable* const> movesetTables);
+
+	/// <summary>
+	/// Drops the cached graph for the given table so that the next request compiles it again, such as after the table was edited.
+	/// Libraries built from the table are dropped as well. Handles to the old graph stay valid until they are released.
+	/// </summary>
+	/// <param name="moveset">The table or cooked moveset whose graph should be dropped</param>
+	static void Invalidate(const UObject* moveset);
+
+	/// <summary>
+	/// Number of graphs that are currently alive in the cache.
+	/// </summary>
+	static int32 GetNumCachedGraphs();
+
+private:
+	static TMap<TObjectKey<UObject>, TWeakPtr<const ComboGraph, ESPMode::ThreadSafe>>& GetCachedGraphs();
+
+	// A cached library with the tables it was built from
+	struct FCachedLibrary
+	{
+		TArray<TObjectKey<UObject>> movesetKeys;
+		TWeakPtr<const ComboMoveSetLibrary, ESPMode::ThreadSafe> library;
+	};
+
+	static TArray<FCachedLibrary>& GetCachedLibraries();
+
+	/// <summary>
+	/// Returns the cached graph for the given key if it is still alive, or creates it with the given function and caches it.
+	/// </summary>
+	static FComboGraphHandle FindOrCreate(const UObject* moveset, TFunctionRef<bool(ComboGraph&)> initializeGraph);
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "ComboGraph.h"
+#include "ComboGraphCompiler.generated.h"
+
+
+/// <summary>
+/// The kinds of problems the compiler can find in a moveset table.
+/// </summary>
+UENUM(BlueprintType)
+enum class EComboGraphDiagnosticType : uint8
+{
+	// The table is missing or has no rows
+	EmptyTable,
+
+	// The table rows are not FAttackAction_Struct rows
+	InvalidRowStruct,
+
+	// The row has no input sequence, so it can never be performed
+	EmptySequence,
+
+	// Another row already uses the same input sequence. Only the first of the rows is kept.
+	DuplicateSequence,
+
+	// No row has the input sequence that leads up to this row, so it can never be reached
+	UnreachableMove,
+
+	// Every row of the table was left out, so the graph would have no moves at all
+	NoValidMoves
+};
+
+
+/// <summary>
+/// One problem found in a moveset table while compiling it into a combo graph.
+/// </summary>
+USTRUCT(BlueprintType)
+struct COMBOSYSTEM_API FComboGraphDiagnostic
+{
+	GENERATED_USTRUCT_BODY()
+
+	/// <summary>
+	/// The kind of problem that was found.
+	/// </summary>
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	EComboGraphDiagnosticType type = EComboGraphDiagnosticType::EmptyTable;
+
+	/// <summary>
+	/// The row the problem was found in. None for problems with the whole table.
+	/// </summary>
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FName rowName;
+
+	/// <summary>
+	/// The other row involved in the problem, such as the row that was kept for a duplicate sequence.
+	/// </summary>
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FName relatedRowName;
+
+	/// <summary>
+	/// Readable description of the problem.
+	/// </summary>
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FString message;
+};
+
+
+/// <summary>
+/// Compiles a moveset table into a combo graph.
+/// The rows are sorted once by input sequence length and then by the inputs themselves. In that order every depth level of the graph
+/// is contiguous, the children of a node are next to each other, and parents of a level appear in the same order as their children,
+/// so the whole graph is built in a single linear pass that matches each row with its parent as it goes.
+/// </summary>
+class COMBOSYSTEM_API ComboGraphCompiler
+{
+public:
+	/// <summary>
+	/// Compiles the table into the graph. Rows with problems are reported and left out of the graph.
+	/// </summary>
+	/// <param name="movesetTable">The table to compile</param>
+	/// <param name="outGraph">The graph to fill. It is emptied if the table cannot be compiled</param>
+	/// <param name="outDiagnostics">Problems found in the table</param>
+	/// <returns>False if the table could not be compiled into a graph at all</returns>
+	static bool Compile(UDataTable* movesetTable, ComboGraph& outGraph, TArray<FComboGraphDiagnostic>& outDiagnostics);
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ComboGraph.h"
+#include "ComboRollback.h"
+#include "UObject/ObjectKey.h"
+
+class UComboComponent;
+
+/// <summary>
+/// One recorded attack input or moveset switch.
+/// </summary>
+struct FComboRecordedInput
+{
+	// World time of the input, in seconds since the recording started
+	double time = 0.0;
+
+	// World time of the frame before the input's, when the combo timers were last updated before the input. Replays update the timers at this time before the input,
+	// so that the deadlines that expired before the input and the ones that expired in its own frame are fired on the same side of it as in the recorded session.
+	double previousFrameTime = 0.0;
+
+	// Index of the recorded actor that received the input
+	uint16 actorIndex = 0;
+
+	// The attack input, or an input made with ComboRollback::MakeSwitchMoveSetInput for a moveset switch
+	uint16 input = 0;
+
+	// Node the actor's cursor was on once the input was processed, used to check that a replay ends up in the same place
+	int32 resultNodeIndex = 0;
+};
+
+/// <summary>
+/// Combo state of a component when an input recording started.
+/// </summary>
+struct FComboRecordedStartState
+{
+	// Node the cursor was on
+	int32 nodeIndex = 0;
+
+	// Seconds left before the combo would have reset for lack of inputs. 0 if no reset was pending.
+	float comboResetDelay = 0.0f;
+
+	// Seconds left of the attack recovery cooldown. 0 if the actor could attack.
+	float attackCooldownDelay = 0.0f;
+
+	// Switchable moveset in use. 0 if the component has no switchable movesets.
+	uint8 moveSetIndex = 0;
+};
+
+/// <summary>
+/// Everything needed to set up a combo component like the one of a recorded actor.
+/// </summary>
+struct FComboRecordedActor
+{
+	// Name of the actor owning the component
+	FString actorName;
+
+	// Object paths of the movesets assigned to the component. Empty if none.
+	FString moveSetPath;
+	FString compiledMoveSetPath;
+	FString staticMoveSet;
+	TArray<FString> switchableMoveSetPaths;
+
+	EComboMissPolicy missPolicy = EComboMissPolicy::ResetWithCooldown;
+	float timeBeforeComboReset = 0.0f;
+	float attackRecoveryCooldown = 0.0f;
+
+	// Combo state of the component when the recording started, so that a recording started mid-combo replays from the same place
+	FComboRecordedStartState startState;
+};
+
+/// <summary>
+/// The stream of attack inputs and moveset switches of a session, with the time of each input and the node it led to.
+/// Written to a compact binary file and replayed headless by the ComboInputReplay commandlet, which clones the recorded components
+/// and checks that the replay goes through the same nodes. Game thread only.
+/// </summary>
+class COMBOSYSTEM_API ComboInputRecording
+{
+public:
+	// Marks the start of an input recording file
+	static constexpr uint32 FileMagic = 0x49424D43; // 'CMBI'
+
+	// Layout version of input recording files. Bump this whenever the recorded structs or the file layout change.
+	static constexpr uint32 FileVersion = 3;
+
+	// Every input received, in order
+	TArray<FComboRecordedInput> inputs;
+
+	// Every actor that received an input, indexed by FComboRecordedInput::actorIndex
+	TArray<FComboRecordedActor> actors;
+
+	// Length of the recording, in seconds of world time
+	double duration = 0.0;
+
+	// Number of world frames the recording spans, so that a replay can use the same average frame length
+	uint32 frameCount = 0;
+
+	/// <summary>
+	/// Stores the combo state a component is in as the recording starts. Components without a stored state are taken to start out of combo.
+	/// </summary>
+	void SetStartState(const UComboComponent* component, const FComboRecordedStartState& startState) { componentStartStates.Add(component, startState); }
+
+	/// <summary>
+	/// Adds an input that a component has just processed. The component's settings are captured the first time it receives an input.
+	/// </summary>
+	/// <param name="component">The component that received the input</param>
+	/// <param name="input">The attack input, or an input made with ComboRollback::MakeSwitchMoveSetInput for a moveset switch</param>
+	/// <param name="time">World time of the input, in seconds since the recording started</param>
+	/// <param name="previousFrameTime">World time of the frame before the input's, in seconds since the recording started</param>
+	void RecordInput(const UComboComponent* component, uint16 input, double time, double previousFrameTime);
+
+	/// <summary>
+	/// Average length of a recorded frame, in seconds. 0 if nothing was recorded.
+	/// </summary>
+	double GetAverageFrameTime() const { return frameCount > 0 ? duration / frameCount : 0.0; }
+
+	/// <summary>
+	/// Writes the recording to a file.
+	/// </summary>
+	/// <returns>False if the file could not be written</returns>
+	bool WriteToFile(const FString& fileName) const;
+
+	/// <summary>
+	/// Reads a recording written by WriteToFile.
+	/// </summary>
+	/// <returns>False if the file could not be read or was written with a different layout version</returns>
+	bool ReadFromFile(const FString& fileName);
+
+private:
+	// Index of each recorded component in the actor array
+	TMap<TObjectKey<UComboComponent>, uint16> componentActorIndices;
+
+	// Combo state of every component registered when the recording started
+	TMap<TObjectKey<UComboComponent>, FComboRecordedStartState> componentStartStates;
+};
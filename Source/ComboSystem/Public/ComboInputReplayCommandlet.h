@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "ComboInputReplayCommandlet.generated.h"
+
+/// <summary>
+/// Replays an attack input recording made with the combo.RecordInputs console command, headless and as fast as possible, as an end-to-end throughput benchmark
+/// and a regression check for timer, cooldown and reset behaviour.
+/// Runs headless, for example: UnrealEditor-Cmd ComboSystem.uproject -run=ComboInputReplay -file=Saved/ComboInputs/Arena.cmbi -clones=100 -nullrhi
+/// Every recorded actor is cloned -clones= times (1 by default), starting in the combo state its actor was in when the recording started.
+/// World time is set to the recorded time of each input, and the combo timers are updated at the recorded time of the frame before it, so deadlines fire on the same side
+/// of every input as in the recorded session. Recorded moveset switches are made with SwitchMoveSet at their place in the stream. Between inputs, world time advances in fixed steps of -step= seconds, the average frame length of the recording by default.
+/// Reports the inputs per second, the latency of each AttackInput or SwitchMoveSet call including any combo reset and delegate broadcast it causes, the cost of the combo timers,
+/// and every input after which a clone is not on the node the recorded actor was on. The commandlet returns 1 if the replay diverged from the recording.
+/// </summary>
+UCLASS()
+class COMBOSYSTEM_API UComboInputReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UComboInputReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+//Stat group of the combo system, shown with "stat ComboGraph"
+DECLARE_STATS_GROUP(TEXT("ComboGraph_Component"), STATGROUP_COMBOGRAPH, STATCAT_Advanced);
+
+// Time spent in each phase of an attack input
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Attack Lookup"), STAT_ComboAttackLookup, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Montage Dispatch"), STAT_ComboMontageDispatch, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Delegate Broadcast"), STAT_ComboDelegateBroadcast, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+
+// Attack inputs resolved this frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Attack Lookups"), STAT_ComboAttackLookups, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Attack Lookup Hits"), STAT_ComboAttackLookupHits, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Attack Lookup Misses"), STAT_ComboAttackLookupMisses, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+
+// Combos that ended this frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Combos Completed"), STAT_ComboCompletions, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Combos Broken"), STAT_ComboBreaks, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+
+// Rates over the whole session
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Lookup Hit Ratio"), STAT_ComboLookupHitRatio, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Combo Completion Rate"), STAT_ComboCompletionRate, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Combo Break Rate"), STAT_ComboBreakRate, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+
+// Histogram of the depth of the attacks resolved over the whole session
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Resolved Depth 1"), STAT_ComboResolvedDepth1, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Resolved Depth 2"), STAT_ComboResolvedDepth2, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Resolved Depth 3"), STAT_ComboResolvedDepth3, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Resolved Depth 4"), STAT_ComboResolvedDepth4, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Resolved Depth 5+"), STAT_ComboResolvedDepth5Plus, STATGROUP_COMBOGRAPH, COMBOSYSTEM_API);
+
+// Insights trace channel of the combo system. Enable it with -trace=cpu,combo, or "trace.enable combo" at runtime.
+UE_TRACE_CHANNEL_EXTERN(ComboChannel, COMBOSYSTEM_API);
+
+// Times a phase of an attack input, both in "stat ComboGraph" and as a CPU event on the combo trace channel
+#define COMBO_PHASE_SCOPE(PhaseName) \
+	SCOPE_CYCLE_COUNTER(STAT_Combo##PhaseName); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Combo##PhaseName, ComboChannel)
+
+
+/// <summary>
+/// Records what the combo components do, for "stat ComboGraph" and the combo Insights trace channel.
+/// Recording costs a few counter updates with stats enabled, and a channel check while the trace channel is off. Must be called on the game thread.
+/// </summary>
+class COMBOSYSTEM_API ComboMetrics
+{
+public:
+	/// <summary>
+	/// Records an attack input that was resolved against a combo graph.
+	/// </summary>
+	/// <param name="hit">Whether the input continued the current chain</param>
+	/// <param name="nodeIndex">Index of the node the input resolved to. INDEX_NONE on a miss</param>
+	/// <param name="resolvedDepth">Depth of the node the input resolved to. 0 on a miss</param>
+	static void RecordAttackLookup(bool hit, int32 nodeIndex, int32 resolvedDepth);
+
+	/// <summary>
+	/// Records the end of a combo that had at least one attack performed.
+	/// </summary>
+	/// <param name="completed">True if the combo reached a finisher, false if it was broken by a wrong input or by timing out</param>
+	/// <param name="finalDepth">Depth of the last attack performed in the combo</param>
+	static void RecordComboEnded(bool completed, int32 finalDepth);
+
+	/// <summary>
+	/// Whether the per-input debug messages are shown on screen, set with the combo.ShowDebugMessages console variable. Off by default.
+	/// </summary>
+	static bool ShowDebugMessages();
+};
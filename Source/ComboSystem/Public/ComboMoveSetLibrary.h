@@ -0,0 +1,121 @@
+#pragma once
+
+#include "ComboGraphCache.h"
+
+/// <summary>
+/// A set of movesets an actor can switch between, such as one per weapon or stance, compiled together.
+/// Movesets often share their button layout and many of their moves, so the library stores each part once:
+/// - Graphs with the same shape, the same chains at the same node indices, share one image. Identical tables share the whole graph.
+/// - Move data is interned by move name and animation, so every node of every moveset performing the same move points at one entry, whatever its chain.
+///   Interning costs an entry index per node, so it is only done when enough moves are shared to pay for it.
+/// - Switching between movesets of the same shape keeps the cursor where it is. Between shapes, it goes through a canonical space, the union of the chains of every shape.
+///   Each node knows its canonical node, and each shape knows the node reached by the longest suffix of every canonical chain, so the cursor maps grow with the number of shapes,
+///   not with pairs of movesets. When the maps would make the library larger than the graphs compiled on their own, they are left out and switching walks the chain instead.
+/// The graphs themselves stay trees, since cursors, failure links, reachability ranges, rollback and replication all identify a combo by the chain that reached it,
+/// so identical branches under different chains cannot share their nodes. The library never takes more memory than its graphs compiled on their own.
+/// Immutable once built, so it can be read from any thread.
+/// </summary>
+class COMBOSYSTEM_API ComboMoveSetLibrary
+{
+private:
+	/// <summary>
+	/// The cursor maps of the graphs sharing one image.
+	/// </summary>
+	struct FGraphShape
+	{
+		// Canonical node of each node of the shape
+		TArray<int32> canonicalNodeIndices;
+
+		// For each canonical node, the node of the shape reached by the longest suffix of its chain that is a chain of the shape.
+		// The whole chain when the shape has it, in which case both nodes are at the same depth. 0 when no suffix is left.
+		TArray<int32> suffixNodeIndices;
+	};
+
+public:
+	/// <summary>
+	/// Compiles every table, shares images, graphs and move data between them and builds the cursor maps, leaving out whatever would not pay for itself.
+	/// </summary>
+	/// <param name="movesetTables">The tables of the movesets, in the order they are switched to by index</param>
+	/// <returns>False if there are no tables or any of them could not be compiled</returns>
+	bool Build(TArrayView<UDataTable* const> movesetTables);
+
+	/// <summary>
+	/// Node of the target moveset that a cursor on the given node of the source moveset moves to when the actor switches moveset.
+	/// Constant time, unless the cursor maps were left out, in which case it costs one step per input of the chain.
+	/// </summary>
+	/// <param name="fromMoveSetIndex">The moveset being switched from</param>
+	/// <param name="toMoveSetIndex">The moveset being switched to</param>
+	/// <param name="nodeIndex">The node the cursor is on in the moveset being switched from</param>
+	/// <param name="missPolicy">With ResumeAtLongestSuffix, a chain missing from the target moveset carries on from its longest suffix that is a chain of it</param>
+	/// <returns>The node reached by the same chain in the target moveset, or 0 if there is none and the combo starts over</returns>
+	int32 MapCursor(int32 fromMoveSetIndex, int32 toMoveSetIndex, int32 nodeIndex, EComboMissPolicy missPolicy) const;
+
+	/// <summary>
+	/// The graph of one of the movesets, or an invalid handle if the index is out of range.
+	/// </summary>
+	FComboGraphHandle GetGraph(int32 moveSetIndex) const { return graphs.IsValidIndex(moveSetIndex) ? graphs[moveSetIndex] : nullptr; }
+
+	/// <summary>
+	/// The graph of one of the movesets without taking a reference on it, for lookups made every frame. Null if the index is out of range.
+	/// </summary>
+	const ComboGraph* FindGraph(int32 moveSetIndex) const { return graphs.IsValidIndex(moveSetIndex) ? graphs[moveSetIndex].Get() : nullptr; }
+
+	// Number of movesets in the library
+	int32 GetNumMoveSets() const { return graphs.Num(); }
+
+	// Number of distinct graph images, one per shape
+	int32 GetNumShapes() const { return shapeCount; }
+
+	// Number of distinct moves, each of which stores its move data once. 0 if the graphs keep their own move data.
+	int32 GetNumMoves() const { return sharedMoveData.IsValid() ? sharedMoveData->Num() : 0; }
+
+	// Number of nodes in the canonical space, the union of the chains of every shape. 0 if the library has no cursor maps.
+	int32 GetNumCanonicalNodes() const { return canonicalNodeCount; }
+
+	/// <summary>
+	/// Memory allocated by the library and its graphs, in bytes.
+	/// </summary>
+	SIZE_T GetAllocatedSize() const;
+
+	/// <summary>
+	/// Memory the graphs of the library took when compiled on their own, before anything was shared, in bytes.
+	/// </summary>
+	SIZE_T GetUnsharedAllocatedSize() const { return unsharedAllocatedSize; }
+
+private:
+	/// <summary>
+	/// Whether two graphs have the same shape: the same chains, at the same node indices, with the same lookup sections.
+	/// The header is left out, since its padding is not part of the graph.
+	/// </summary>
+	static bool HasSameShape(const ComboGraph& graph, const ComboGraph& otherGraph);
+
+	/// <summary>
+	/// Builds the canonical space and the cursor maps of every shape.
+	/// </summary>
+	/// <param name="shapeGraphs">A graph of each shape</param>
+	/// <param name="builtShapeIndices">Shape of every moveset's graph</param>
+	void BuildCursorMaps(const TArray<TSharedRef<ComboGraph, ESPMode::ThreadSafe>>& shapeGraphs, const TArray<int32>& builtShapeIndices);
+
+	/// <summary>
+	/// Node of the target graph reached by the longest suffix of a node's chain that is a chain of the target graph, found by walking the chain. 0 if there is none.
+	/// </summary>
+	static int32 FindLongestSuffixNode(const ComboGraph& fromGraph, int32 nodeIndex, const ComboGraph& toGraph);
+
+	// The graph of every moveset
+	TArray<FComboGraphHandle> graphs;
+
+	// Shape of every moveset's graph. Empty if the library has no cursor maps.
+	TArray<int32> moveSetShapeIndices;
+
+	// Cursor maps of every distinct shape. Empty if the movesets all have the same shape, or if the maps would take more memory than the library saves.
+	TArray<FGraphShape> shapes;
+
+	// Move data of every distinct move, shared by the graphs. Null if the graphs keep their own move data.
+	TSharedPtr<const TArray<FComboGraphMoveData>, ESPMode::ThreadSafe> sharedMoveData;
+
+	int32 shapeCount = 0;
+
+	int32 canonicalNodeCount = 0;
+
+	SIZE_T unsharedAllocatedSize = 0;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "ComboGraphCompiler.h"
+#include "ComboMovesetAsset.generated.h"
+
+/// <summary>
+/// A moveset that has been compiled ahead of time into a combo graph image.
+/// The image is produced from the source table whenever the asset is saved or cooked, and is bulk loaded with the asset,
+/// so at runtime the graph uses it in place without rebuilding anything from the table rows.
+/// </summary>
+UCLASS(BlueprintType)
+class COMBOSYSTEM_API UComboMovesetAsset : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	/// <summary>
+	/// The moveset table the graph is compiled from.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TSoftObjectPtr<UDataTable> sourceTable;
+
+	/// <summary>
+	/// What happens when an input does not continue the current chain, for every actor using this moveset.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	EComboMissPolicy missPolicy = EComboMissPolicy::ResetWithCooldown;
+
+	/// <summary>
+	/// Move data of every node in the compiled graph, in node order.
+	/// </summary>
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<FComboGraphMoveData> nodeMoveData;
+
+	/// <summary>
+	/// Problems found in the source table the last time the graph was compiled.
+	/// </summary>
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<FComboGraphDiagnostic> compileDiagnostics;
+
+private:
+	/// <summary>
+	/// The compiled graph image. Serialized in bulk rather than as a property so loading it is a single copy.
+	/// </summary>
+	TArray<uint8> graphImage;
+
+	/// <summary>
+	/// Images and move data replaced by a rebuild while graphs may still be using them in place. Kept until the asset is unloaded.
+	/// </summary>
+	TArray<TArray<uint8>> retiredGraphImages;
+	TArray<TArray<FComboGraphMoveData>> retiredNodeMoveData;
+
+public:
+	/// <summary>
+	/// Compiles the source table and stores the resulting graph image in the asset. Graphs already using the previous image stay valid.
+	/// </summary>
+	/// <returns>False if the source table could not be loaded or compiled, in which case the stored image is left unchanged and the problems are in compileDiagnostics</returns>
+	bool RebuildFromSourceTable();
+
+	/// <summary>
+	/// Checks that the stored image and move data are up to date with the source table, by comparing them with a freshly compiled graph and looking up every row of the table in it.
+	/// </summary>
+	/// <param name="outError">Description of the first mismatch found</param>
+	/// <returns>False if the stored image or move data does not match the source table</returns>
+	bool VerifyAgainstSourceTable(FString& outError);
+
+	/// <summary>
+	/// Initializes a graph that uses the stored image in place. The asset must outlive the graph, which ComboGraphCache ensures for the graphs it hands out.
+	/// </summary>
+	/// <returns>False if there is no valid image stored in the asset</returns>
+	bool InitializeGraph(ComboGraph& outGraph) const;
+
+	// Whether the asset holds a compiled graph image
+	bool HasGraphImage() const { return graphImage.Num() > 0; }
+
+	virtual void Serialize(FArchive& Ar) override;
+
+#if WITH_EDITOR
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+#endif
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "ComboMovesetCookCommandlet.generated.h"
+
+/// <summary>
+/// Regenerates the graph images of every cooked moveset asset from its source table, then checks each image against the table.
+/// Runs headless, for example: UnrealEditor-Cmd ComboSystem.uproject -run=ComboMovesetCook -nullrhi
+/// Pass -verify to only check the stored images without rebuilding or saving anything. The commandlet returns 1 if any moveset fails.
+/// </summary>
+UCLASS()
+class COMBOSYSTEM_API UComboMovesetCookCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UComboMovesetCookCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "ComboMovesetHeaderCommandlet.generated.h"
+
+/// <summary>
+/// Compiles a moveset table into a C++ header, for movesets that are locked at ship time. The header holds the graph image, a constexpr transition table
+/// with the next node for every node and input, and the node metadata, and registers the moveset so that combo components can use it through staticMoveSet.
+/// Runs headless, for example: UnrealEditor-Cmd ComboSystem.uproject -run=ComboMovesetHeader -table=/Game/Movesets/DT_Hero.DT_Hero -name=Hero -output=Source/Game/HeroMoveset.h
+/// The name must be a valid C++ identifier. Include the header in one source file of the game module, and regenerate it whenever the table changes.
+/// The commandlet returns 1 if the table could not be loaded, compiled or written out.
+/// </summary>
+UCLASS()
+class COMBOSYSTEM_API UComboMovesetHeaderCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UComboMovesetHeaderCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ComboReplicatedState.generated.h"
+
+/// <summary>
+/// Server-authoritative combo state of a combo component, as replicated to clients.
+/// The compiled combo graph is the same on every machine, so the index of the last attack node is enough to rebuild the cursor, the move data and the montage.
+/// On the wire the node index takes only as many bits as the graph's node count needs, so a state costs about 24 bits for typical movesets.
+/// The index of the active moveset costs a single bit while it is the first one.
+/// </summary>
+USTRUCT()
+struct COMBOSYSTEM_API FComboReplicatedState
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of bits of the input sequence counter
+	static constexpr uint32 InputSequenceBits = 6;
+	static constexpr uint8 InputSequenceMask = (1 << InputSequenceBits) - 1;
+
+	// Number of bits used to send the width of the node index
+	static constexpr uint32 NodeIndexWidthBits = 5;
+
+	// Number of bits of the performed attack counter
+	static constexpr uint32 AttackCounterBits = 4;
+	static constexpr uint8 AttackCounterMask = (1 << AttackCounterBits) - 1;
+
+	// Node of the attack performed by the last input the server resolved. 0 if that input did not perform an attack.
+	int32 attackNodeIndex = 0;
+
+	// Sequence number of the last attack input of the owning client the server resolved, whether or not it performed an attack. Wraps around.
+	uint8 inputSequence = 0;
+
+	// Number of attacks the server has performed, wrapping around. Simulated proxies play the attack's montage when it changes.
+	uint8 attackCounter = 0;
+
+	// Whether the combo ended after the attack, either because it was the last of its chain or because the chain was broken
+	bool comboEnded = false;
+
+	// Number of bits needed for any node index of the server's graph. Set by the server when it acquires the graph.
+	uint8 nodeIndexBits = 0;
+
+	// Moveset the server's component has switched to, when it switches between several. The node index refers to this moveset's graph.
+	uint8 moveSetIndex = 0;
+
+	// Node the cursor is on according to this state
+	int32 GetCursorNodeIndex() const { return comboEnded ? 0 : attackNodeIndex; }
+
+	// Difference between two input sequence numbers, taking wrap-around into account. Positive if a comes after b.
+	static int32 GetInputSequenceDelta(uint8 a, uint8 b)
+	{
+		constexpr int32 halfRange = (InputSequenceMask + 1) / 2;
+		return ((int32(a) - int32(b) + halfRange) & InputSequenceMask) - halfRange;
+	}
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FComboReplicatedState& other) const
+	{
+		return attackNodeIndex == other.attackNodeIndex && inputSequence == other.inputSequence && attackCounter == other.attackCounter && comboEnded == other.comboEnded
+			&& nodeIndexBits == other.nodeIndexBits && moveSetIndex == other.moveSetIndex;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FComboReplicatedState> : public TStructOpsTypeTraitsBase2<FComboReplicatedState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "ComboGraph.h"
+
+class ComboMoveSetLibrary;
+
+/// <summary>
+/// What happened to a combo state during the last simulated frame.
+/// </summary>
+enum class EComboRollbackFrameFlags : uint8
+{
+	None = 0,
+
+	// An input continued the chain and the attack of the event node was performed
+	AttackPerformed = 1 << 0,
+
+	// An input was received while the attack cooldown was active
+	InputIgnored = 1 << 1,
+
+	// The combo was broken by an input that did not continue the chain
+	ComboBroken = 1 << 2,
+
+	// The combo was broken because no input was received within the combo reset window
+	ComboTimedOut = 1 << 3,
+
+	// The attack performed was the last of its chain
+	ComboCompleted = 1 << 4,
+
+	// The actor switched to another moveset of its library
+	MoveSetSwitched = 1 << 5
+};
+ENUM_CLASS_FLAGS(EComboRollbackFrameFlags);
+
+/// <summary>
+/// The whole combo state of one actor in fixed-step mode, including the moveset it uses. Plain data with no pointers, so a snapshot is a 16 byte copy,
+/// and restoring it puts the actor back exactly where it was.
+/// </summary>
+struct FComboRollbackState
+{
+	// Node of the combo graph the actor is on. 0 is the root node, meaning no combo is in progress.
+	int32 nodeIndex = 0;
+
+	// Node the flags of the last frame refer to: the attack performed, or the last attack of the combo that ended. 0 if none.
+	// On a frame that switches moveset, a node of the moveset switched from.
+	int32 eventNodeIndex = 0;
+
+	// Frames left before the combo resets for lack of inputs. 0 when no reset is pending.
+	uint16 comboResetFrames = 0;
+
+	// Frames left before the actor can attack again. 0 when the actor can attack.
+	uint16 attackCooldownFrames = 0;
+
+	// EComboRollbackFrameFlags of the last simulated frame
+	uint8 frameFlags = 0;
+
+	// Moveset of the actor's library the node belongs to. Always 0 for actors without switchable movesets.
+	uint8 moveSetIndex = 0;
+
+	uint8 padding[2] = {};
+
+	bool HasFrameFlag(EComboRollbackFrameFlags flag) const { return EnumHasAnyFlags(static_cast<EComboRollbackFrameFlags>(frameFlags), flag); }
+
+	bool operator==(const FComboRollbackState& other) const { return FMemory::Memcmp(this, &other, sizeof(FComboRollbackState)) == 0; }
+	bool operator!=(const FComboRollbackState& other) const { return !(*this == other); }
+};
+static_assert(std::is_trivially_copyable_v<FComboRollbackState>, "Combo rollback states are copied as raw memory");
+static_assert(sizeof(FComboRollbackState) == 16, "Combo rollback states are meant to stay small enough to snapshot every frame");
+
+/// <summary>
+/// Timings of a combo in frames, as used by the fixed-step simulation.
+/// </summary>
+struct FComboRollbackConfig
+{
+	// Frames without input after which the combo resets
+	uint16 comboResetFrames = 0;
+
+	// Frames the actor cannot attack for after a combo ends
+	uint16 attackCooldownFrames = 0;
+
+	// What happens when an input does not continue the chain
+	EComboMissPolicy missPolicy = EComboMissPolicy::ResetWithCooldown;
+};
+
+/// <summary>
+/// Deterministic fixed-step simulation of a combo state. Only integer frame counts and graph lookups are involved, so the same inputs from the same state
+/// always give the same result on every machine. Nothing is allocated and no side effect happens, so frames can be resimulated as often as rollback needs.
+/// </summary>
+class COMBOSYSTEM_API ComboRollback
+{
+public:
+	// Input value for frames without an attack input
+	static constexpr int32 NoInput = INDEX_NONE;
+
+	// Input values from this one up switch moveset instead of attacking. Attack inputs fit in a byte, so the two never overlap.
+	static constexpr int32 SwitchMoveSetInputBase = 1 << 8;
+
+	/// <summary>
+	/// The input value of a frame that switches to the given moveset of the actor's library.
+	/// </summary>
+	static int32 MakeSwitchMoveSetInput(int32 moveSetIndex) { return SwitchMoveSetInputBase + moveSetIndex; }
+
+	// Whether an input value switches moveset
+	static bool IsSwitchMoveSetInput(int32 input) { return input >= SwitchMoveSetInputBase; }
+
+	/// <summary>
+	/// Advances the state by one frame: counts the timers down, then applies the input of the frame.
+	/// </summary>
+	/// <param name="graph">The combo graph of the actor's moveset</param>
+	/// <param name="config">Timings of the combo in frames</param>
+	/// <param name="state">The state to advance</param>
+	/// <param name="input">The attack input of the frame, or NoInput. Inputs that switch moveset do nothing, since a single graph has no other moveset.</param>
+	static void SimulateFrame(const ComboGraph& graph, const FComboRollbackConfig& config, FComboRollbackState& state, int32 input);
+
+	/// <summary>
+	/// Advances the state of an actor with switchable movesets by one frame: counts the timers down, then applies the input of the frame
+	/// to the moveset the state is on. An input that switches moveset moves the node to the same chain in the new moveset, or breaks the combo
+	/// as the miss policy decides when the new moveset does not have it.
+	/// </summary>
+	/// <param name="library">The movesets the actor switches between</param>
+	/// <param name="config">Timings of the combo in frames</param>
+	/// <param name="state">The state to advance</param>
+	/// <param name="input">The attack input of the frame, an input made with MakeSwitchMoveSetInput, or NoInput</param>
+	static void SimulateFrame(const ComboMoveSetLibrary& library, const FComboRollbackConfig& config, FComboRollbackState& state, int32 input);
+
+	/// <summary>
+	/// Advances the state by one frame per input.
+	/// </summary>
+	static void Resimulate(const ComboGraph& graph, const FComboRollbackConfig& config, FComboRollbackState& state, TArrayView<const int32> frameInputs);
+
+	/// <summary>
+	/// Advances the state of an actor with switchable movesets by one frame per input.
+	/// </summary>
+	static void Resimulate(const ComboMoveSetLibrary& library, const FComboRollbackConfig& config, FComboRollbackState& state, TArrayView<const int32> frameInputs);
+
+	/// <summary>
+	/// Converts a duration to a whole number of frames, rounding up so that a timer never ends early.
+	/// </summary>
+	static uint16 SecondsToFrames(float seconds, int32 frameRate);
+};
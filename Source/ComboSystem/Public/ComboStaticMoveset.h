@@ -0,0 +1,121 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// <summary>
+/// A moveset compiled into the game as C++, from a header written by the ComboMovesetHeader commandlet.
+/// Holds the same graph image a cooked moveset asset would, plus a dense transition table with the next node for every node and input,
+/// so a graph using it resolves any input with a single table index. Everything it points to is constant data of the game module.
+/// </summary>
+struct FComboStaticMovesetTable
+{
+	// Name components refer to the moveset by
+	const TCHAR* name = nullptr;
+
+	// The graph image, aligned to 16 bytes
+	const uint8* image = nullptr;
+	int32 imageSize = 0;
+
+	// Number of nodes in the graph, including the root node
+	int32 nodeCount = 0;
+
+	// Number of columns of the transition table. Column 0 is shared by every input the moveset does not use.
+	int32 symbolCount = 0;
+
+	// Column of the transition table for each of the 256 inputs
+	const uint16* inputSymbols = nullptr;
+
+	// Next node for every node and column, as nodeCount rows of symbolCount entries. INDEX_NONE where the input does not continue the chain.
+	const int32* transitions = nullptr;
+
+	// Move data of every node, in node order. Animation paths are soft object paths, empty for the root node.
+	const TCHAR* const* rowNames = nullptr;
+	const TCHAR* const* moveNames = nullptr;
+	const TCHAR* const* attackAnimationPaths = nullptr;
+};
+
+
+/// <summary>
+/// Lookups in a moveset compiled into the game, specialized on the generated moveset type so that the compiler sees the whole table
+/// and can inline lookups, or resolve them entirely when the inputs are constants.
+/// TMoveset is a struct written by the ComboMovesetHeader commandlet.
+/// </summary>
+template<typename TMoveset>
+struct TComboStaticMatcher
+{
+	// Node reached from the given node with the given input, or INDEX_NONE if the input does not continue the chain
+	static constexpr int32 Advance(int32 nodeIndex, uint8 input)
+	{
+		return TMoveset::Transitions[nodeIndex * TMoveset::SymbolCount + TMoveset::InputSymbols[input]];
+	}
+
+	// Node a whole attack chain leads to from the root, or INDEX_NONE if it is not a chain of the moveset
+	template<typename... TInputs>
+	static constexpr int32 MatchChain(TInputs... inputs)
+	{
+		int32 nodeIndex = 0;
+		((nodeIndex = nodeIndex != INDEX_NONE ? Advance(nodeIndex, static_cast<uint8>(inputs)) : INDEX_NONE), ...);
+		return nodeIndex;
+	}
+
+	// Whether the node is the last attack of its chain
+	static constexpr bool IsChainEnd(int32 nodeIndex)
+	{
+		return TMoveset::ChildCounts[nodeIndex] == 0;
+	}
+
+	// The runtime view of the moveset, through which combo components use it
+	static constexpr FComboStaticMovesetTable MakeTable()
+	{
+		FComboStaticMovesetTable table;
+		table.name = TMoveset::Name;
+		table.image = TMoveset::Image;
+		table.imageSize = sizeof(TMoveset::Image);
+		table.nodeCount = TMoveset::NodeCount;
+		table.symbolCount = TMoveset::SymbolCount;
+		table.inputSymbols = TMoveset::InputSymbols;
+		table.transitions = TMoveset::Transitions;
+		table.rowNames = TMoveset::RowNames;
+		table.moveNames = TMoveset::MoveNames;
+		table.attackAnimationPaths = TMoveset::AttackAnimationPaths;
+		return table;
+	}
+};
+
+
+/// <summary>
+/// Every moveset compiled into the game, so that combo components can find them by name.
+/// Movesets register themselves during static initialization, before any component looks them up.
+/// </summary>
+class COMBOSYSTEM_API ComboStaticMovesetRegistry
+{
+public:
+	/// <summary>
+	/// Adds a moveset to the registry. The table must live for the whole process.
+	/// </summary>
+	static void Register(const FComboStaticMovesetTable* staticMoveset);
+
+	/// <summary>
+	/// Returns the moveset compiled into the game under the given name, or null if there is none.
+	/// </summary>
+	static const FComboStaticMovesetTable* Find(FName movesetName);
+
+private:
+	static TArray<const FComboStaticMovesetTable*>& GetRegisteredMovesets();
+};
+
+
+/// <summary>
+/// Registers a generated moveset when the module it is compiled into is loaded. Generated headers declare one of these for their moveset.
+/// </summary>
+template<typename TMoveset>
+struct TComboStaticMovesetRegistration
+{
+	// Constant data, so it is ready before any dynamic initializer runs
+	static constexpr FComboStaticMovesetTable Table = TComboStaticMatcher<TMoveset>::MakeTable();
+
+	TComboStaticMovesetRegistration()
+	{
+		ComboStaticMovesetRegistry::Register(&Table);
+	}
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Animation/AnimNotifies/AnimNotifyState.h"
+#include "ComboWindowNotifyState.generated.h"
+
+/// <summary>
+/// The kinds of window an attack montage can open on its combo component.
+/// </summary>
+UENUM(BlueprintType)
+enum class EComboWindowType : uint8
+{
+	// The next input of the chain is accepted. It is queued until a cancel window opens, or until the montage blends out if there is none.
+	AcceptInput,
+
+	// The montage can be cut short. A queued or newly received input starts the next attack right away.
+	Cancel
+};
+
+/// <summary>
+/// Marks a combo window on an attack montage. The window is opened on the combo component of the actor playing the montage when the notify begins,
+/// and closed when it ends, so combo timing is evaluated only at the window edges.
+/// Attacks whose montage has at least one combo window ignore timeBeforeComboReset: their chain ends when the montage blends out without a next input.
+/// </summary>
+UCLASS(meta = (DisplayName = "Combo Window"))
+class COMBOSYSTEM_API UComboWindowNotifyState : public UAnimNotifyState
+{
+	GENERATED_BODY()
+
+public:
+	/// <summary>
+	/// The kind of window this notify opens.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat)
+	EComboWindowType windowType = EComboWindowType::AcceptInput;
+
+	/// <summary>
+	/// Whether the montage has at least one combo window.
+	/// </summary>
+	static bool HasComboWindows(const UAnimSequenceBase* animation);
+
+	// UAnimNotifyState interface
+	virtual void NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration, const FAnimNotifyEventReference& EventReference) override;
+	virtual void NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference) override;
+	virtual FString GetNotifyName_Implementation() const override;
+	// End of UAnimNotifyState interface
+};
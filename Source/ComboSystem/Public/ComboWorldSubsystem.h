@@ -0,0 +1,304 @@
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "ComboGraph.h"
+#include "ComboEventRecorder.h"
+#include "ComboInputRecording.h"
+#include "ComboWorldSubsystem.generated.h"
+
+class UComboComponent;
+
+/// <summary>
+/// One attack input to resolve as part of a batch.
+/// </summary>
+USTRUCT(BlueprintType)
+struct COMBOSYSTEM_API FComboAttackInputRequest
+{
+	GENERATED_USTRUCT_BODY()
+
+	/// <summary>
+	/// The component receiving the input.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UComboComponent* component = nullptr;
+
+	/// <summary>
+	/// The type of attack that is being performed.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TEnumAsByte<AttackType_Enum> attackType = LightAttack;
+};
+
+/// <summary>
+/// Owns the per-actor combo timers and flags of every combo component in the world.
+/// Timers are absolute deadlines kept in a min-heap, and the subsystem only ticks while a deadline is pending, firing each one when it expires.
+/// Idle components therefore cost nothing per frame, except for components that buffer their attack inputs, whose buffers are drained every frame.
+/// Components register when they begin play and refer to their state through the slot they are given.
+/// </summary>
+UCLASS()
+class COMBOSYSTEM_API UComboWorldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+// Private types
+private:
+	/// <summary>
+	/// The kinds of deadline a component can have pending.
+	/// </summary>
+	enum class EComboDeadlineType : uint8
+	{
+		// The combo sequence resets because the actor took too long to perform the next attack in the chain
+		ComboReset,
+
+		// The attack cooldown is over and the actor can attack again
+		AttackCooldownEnd
+	};
+
+	/// <summary>
+	/// Outcome of resolving one request of an attack input batch.
+	/// </summary>
+	struct FComboResolvedInput
+	{
+		// The graph to resolve the input against. Null if the request is not resolved in parallel.
+		const ComboGraph* graph = nullptr;
+
+		// The cursor of the component, advanced by the input once resolved
+		FComboGraphCursor cursor;
+
+		// What happens if the input does not continue the chain
+		EComboMissPolicy missPolicy = EComboMissPolicy::ResetWithCooldown;
+
+		// The attack the input resolved to. Null if the input does not continue the chain.
+		const FComboGraphNode* attackToPerform = nullptr;
+
+		// Whether the request could not be resolved in parallel and goes through the regular input path during the commit instead
+		bool deferred = false;
+	};
+
+	/// <summary>
+	/// An entry in the deadline heap.
+	/// Entries are not removed when a deadline is moved or cancelled, they are skipped when they no longer match the deadline stored for the component.
+	/// </summary>
+	struct FComboDeadline
+	{
+		// World time at which the deadline expires
+		double expiryTime = 0.0;
+
+		// The component the deadline belongs to
+		TWeakObjectPtr<UComboComponent> component;
+
+		EComboDeadlineType type = EComboDeadlineType::ComboReset;
+
+		// Orders the heap so that the earliest deadline is on top
+		bool operator<(const FComboDeadline& other) const { return expiryTime < other.expiryTime; }
+	};
+
+// Private variables and properties
+private:
+	// The component owning each slot
+	UPROPERTY(Transient)
+	TArray<UComboComponent*> slotComponents;
+
+	// World time at which each slot's combo sequence resets. 0 when no reset is pending.
+	TArray<double> comboResetDeadline;
+
+	// World time at which each slot's attack cooldown ends. 0 when no cooldown is active.
+	TArray<double> attackCooldownDeadline;
+
+	// Whether the component in each slot can perform an attack
+	TArray<bool> canAttack;
+
+	// Registered components that buffer their attack inputs, drained every frame
+	UPROPERTY(Transient)
+	TArray<UComboComponent*> inputBufferComponents;
+
+	// Copy of inputBufferComponents being drained this frame, kept between frames so that the drain does not allocate
+	UPROPERTY(Transient)
+	TArray<UComboComponent*> drainingInputBufferComponents;
+
+	// Pending deadlines of every slot, earliest first
+	TArray<FComboDeadline> deadlineHeap;
+
+	// Scratch space for resolving attack input batches, kept between batches so that a batch does not allocate
+	TArray<FComboResolvedInput> resolvedBatchInputs;
+
+	// Whether an attack input batch is being processed. Batches started by its delegates wait until it is done, so that they do not overwrite its scratch space.
+	bool processingAttackInputBatch = false;
+
+	// Requests of the batches started while a batch was being processed, and the ones being resolved from them. Kept between batches so that they do not allocate.
+	TArray<FComboAttackInputRequest> deferredBatchRequests;
+	TArray<FComboAttackInputRequest> runningBatchRequests;
+
+	// Recent combo events of every component in the world, for post-mortem debugging
+	ComboEventRecorder eventRecorder;
+
+	// Handle of the binding that dumps the events when the engine hits a fatal error
+	FDelegateHandle systemErrorHandle;
+
+	// The attack inputs recorded so far. Null while no recording is in progress.
+	TUniquePtr<ComboInputRecording> inputRecording;
+
+	// World time and engine frame at which the input recording started
+	double inputRecordingStartTime = 0.0;
+	uint64 inputRecordingStartFrame = 0;
+
+// Private functions
+private:
+	/// <summary>
+	/// Adds a deadline to the heap.
+	/// </summary>
+	void ScheduleDeadline(int32 slot, EComboDeadlineType type, double expiryTime);
+
+	/// <summary>
+	/// Returns the deadline currently stored for the slot, for the given kind of deadline.
+	/// </summary>
+	double GetSlotDeadline(int32 slot, EComboDeadlineType type) const;
+
+	/// <summary>
+	/// Current time of the world the subsystem belongs to.
+	/// </summary>
+	double GetCurrentTime() const;
+
+	/// <summary>
+	/// Time of the world's previous frame, when the subsystem last updated the combo timers.
+	/// </summary>
+	double GetPreviousFrameTime() const;
+
+	/// <summary>
+	/// Writes the recorded events next to the other saved files when the engine hits a fatal error.
+	/// </summary>
+	void DumpEventsOnSystemError();
+
+	/// <summary>
+	/// Resolves one batch of attack inputs in the prepare, resolve and commit phases described on ProcessAttackInputBatch.
+	/// </summary>
+	void ResolveAttackInputBatch(TArrayView<const FComboAttackInputRequest> requests);
+
+// Public functions
+public:
+	/// <summary>
+	/// Adds a component to the subsystem.
+	/// </summary>
+	/// <returns>The slot holding the component's combo state</returns>
+	int32 RegisterComponent(UComboComponent* component);
+
+	/// <summary>
+	/// Removes a component from the subsystem. The last slot is moved into the freed one, and its component is told about its new slot.
+	/// </summary>
+	void UnregisterComponent(int32 slot);
+
+	/// <summary>
+	/// Restarts the combo reset window of a slot because an attack input was received.
+	/// </summary>
+	void NotifyAttackInput(int32 slot, float comboResetTime);
+
+	/// <summary>
+	/// Cancels the pending combo reset of a slot, for attacks whose chain ends with their montage instead of a timer.
+	/// </summary>
+	void CancelComboReset(int32 slot) { comboResetDeadline[slot] = 0.0; }
+
+	/// <summary>
+	/// Stops the slot from attacking until the cooldown has passed. Cancels any pending combo reset.
+	/// </summary>
+	void StartAttackCooldown(int32 slot, float cooldownTime);
+
+	/// <summary>
+	/// Resolves a batch of attack inputs, such as every input received by a crowd of AI actors in one tick. Must be called on the game thread.
+	/// The combo transitions are resolved in parallel against the shared combo graphs, then the side effects (montages, cooldowns, delegates)
+	/// are applied one request at a time, in order, on the game thread. When a component appears more than once in a batch,
+	/// only its first input is resolved in parallel, the later ones go through AttackInput during the commit so that they see its effects.
+	/// Inputs of network proxies also go through AttackInput during the commit, so that autonomous proxies predict them and send them to the server, and simulated proxies ignore them.
+	/// A batch started by a delegate during the commit is resolved once the current batch is done.
+	/// </summary>
+	/// <param name="requests">The inputs to resolve</param>
+	void ProcessAttackInputBatch(TArrayView<const FComboAttackInputRequest> requests);
+
+	/// <summary>
+	/// Blueprint version of ProcessAttackInputBatch.
+	/// </summary>
+	UFUNCTION(BlueprintCallable, Category = Combat, meta = (DisplayName = "Process Attack Input Batch"))
+	void K2_ProcessAttackInputBatch(const TArray<FComboAttackInputRequest>& requests) { ProcessAttackInputBatch(requests); }
+
+	/// <summary>
+	/// Records a combo event of a component in the world's event ring buffer. Does not allocate.
+	/// </summary>
+	void RecordEvent(EComboTraceEventType type, const UComboComponent* component, int32 nodeIndex = INDEX_NONE, int32 depth = 0, uint8 payload = 0);
+
+	/// <summary>
+	/// Writes the recorded events to a file, which can be turned into per-actor timelines with the ComboEventDump commandlet.
+	/// </summary>
+	/// <param name="fileName">The file to write. Empty to write a new file under Saved/ComboEvents</param>
+	/// <returns>False if the file could not be written</returns>
+	bool DumpEvents(const FString& fileName) const;
+
+	// The recorded events of every component in the world
+	const ComboEventRecorder& GetEventRecorder() const { return eventRecorder; }
+
+	/// <summary>
+	/// Starts recording every attack input in the world, direct, buffered or batched, for replay with the ComboInputReplay commandlet. Drops any recording already in progress.
+	/// </summary>
+	void StartInputRecording();
+
+	/// <summary>
+	/// Stops recording attack inputs and writes the recording to a file.
+	/// </summary>
+	/// <param name="fileName">The file to write. Empty to write a new file under Saved/ComboInputs</param>
+	/// <returns>False if no recording was in progress or the file could not be written</returns>
+	bool StopInputRecording(const FString& fileName);
+
+	// Whether attack inputs are being recorded
+	bool IsRecordingInputs() const { return inputRecording.IsValid(); }
+
+	/// <summary>
+	/// Adds an attack input that a component has just processed to the recording in progress, if any.
+	/// Called once per input, whether it came straight from AttackInput, from the input buffer or from a batch.
+	/// </summary>
+	void RecordAttackInput(const UComboComponent* component, uint8 attackInput)
+	{
+		if (inputRecording.IsValid())
+		{
+			inputRecording->RecordInput(component, attackInput, GetCurrentTime() - inputRecordingStartTime, GetPreviousFrameTime() - inputRecordingStartTime);
+		}
+	}
+
+	/// <summary>
+	/// Adds a moveset switch that a component has just made to the recording in progress, if any, in order with its attack inputs.
+	/// </summary>
+	void RecordMoveSetSwitch(const UComboComponent* component, int32 moveSetIndex)
+	{
+		if (inputRecording.IsValid())
+		{
+			inputRecording->RecordInput(component, static_cast<uint16>(ComboRollback::MakeSwitchMoveSetInput(moveSetIndex)), GetCurrentTime() - inputRecordingStartTime, GetPreviousFrameTime() - inputRecordingStartTime);
+		}
+	}
+
+	/// <summary>
+	/// Puts a component in the combo state it was in when an input recording started: its cursor, and the combo reset or attack cooldown it was waiting for.
+	/// Used by replays. The component must have begun play.
+	/// </summary>
+	void RestoreRecordedStartState(UComboComponent* component, const FComboRecordedStartState& startState);
+
+	// Whether the component in the slot can perform an attack right now
+	bool CanAttack(int32 slot) const { return canAttack[slot]; }
+
+	// Number of components registered with the subsystem
+	int32 GetNumRegisteredComponents() const { return slotComponents.Num(); }
+
+	// Number of entries in the deadline heap, including ones that have been moved or cancelled
+	int32 GetNumPendingDeadlines() const { return deadlineHeap.Num(); }
+
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	// Combo state exists in every world where components begin play: game worlds, and the preview worlds of editors and tools
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual bool IsTickableInEditor() const override { return true; }
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+};
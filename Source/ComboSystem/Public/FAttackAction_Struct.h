@@ -29,11 +29,32 @@ struct COMBOSYSTEM_API FAttackAction_Struct : public FTableRowBase
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 		TArray<TEnumAsByte<AttackType_Enum>> requiredSequenceToActivateAttack;
 
+	/// <summary>
+	/// The input symbols required to activate this attack, for movesets with more inputs than the attack types, such as directions, stances or button chords.
+	/// Symbols 0 to 2 are the attack types. When not empty, this is used instead of requiredSequenceToActivateAttack.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		TArray<uint8> requiredInputSymbols;
+
 
 	/// <summary>
 	/// The animation to be used for this attack.
+	/// This is a soft reference so that loading the table does not load every montage of the moveset. Combo components stream in the montages of the attacks they can reach next.
 	/// </summary>
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-		UAnimMontage* attackAnimation;
+		TSoftObjectPtr<UAnimMontage> attackAnimation;
+
+	/// <summary>
+	/// The input sequence of the row as symbols, from requiredInputSymbols when it is authored and from requiredSequenceToActivateAttack otherwise.
+	/// </summary>
+	TArrayView<const uint8> GetRequiredInputs() const
+	{
+		if (requiredInputSymbols.Num() > 0)
+		{
+			return requiredInputSymbols;
+		}
 
+		static_assert(sizeof(TEnumAsByte<AttackType_Enum>) == sizeof(uint8), "Attack types are read as input symbols");
+		return TArrayView<const uint8>(reinterpret_cast<const uint8*>(requiredSequenceToActivateAttack.GetData()), requiredSequenceToActivateAttack.Num());
+	}
 };